@@ -0,0 +1,147 @@
+#pragma once
+
+#include "LevelMeterConstants.h"
+#include "LevelMeterOverloadLog.h"
+
+#include <cstdint>
+#include <juce_core/juce_core.h>
+
+#if JUCE_MSVC
+    #include <intrin.h>
+#endif
+
+/**
+ * Detects clipping as runs of consecutive samples at or above a threshold. The detector works on the bit masks created
+ * by the MeasurementKernel, which means it does work per run of samples instead of per sample. Runs which straddle
+ * block boundaries are carried over to the next block using a State.
+ */
+class ClipDetector
+{
+public:
+    using Event = LevelMeterOverloadLog::Event;
+
+    /**
+     * Options to configure the detector.
+     */
+    struct Options
+    {
+        /// The absolute sample value at or above which a sample counts as clipped.
+        float threshold = LevelMeterConstants::kOverloadTriggerLevel;
+
+        /// The number of consecutive clipped samples needed to count as clipping.
+        int minRunLength = 1;
+    };
+
+    /**
+     * The state of a single channel, which must be kept between blocks.
+     */
+    struct State
+    {
+        /// The current run, which is open when its runLength is larger than 0.
+        Event run;
+    };
+
+    ClipDetector() = default;
+
+    explicit ClipDetector (const Options& options) : mOptions (options)
+    {
+        jassert (mOptions.minRunLength >= 1);
+    }
+
+    /**
+     * @return The options of this detector.
+     */
+    [[nodiscard]] const Options& getOptions() const
+    {
+        return mOptions;
+    }
+
+    /**
+     * Processes the mask of a chunk of at most 64 samples.
+     * @param mask The mask, where bit i is set when sample i of the chunk is at or above the threshold.
+     * @param chunk The samples of the chunk.
+     * @param length The number of samples of the chunk.
+     * @param position The position of the first sample of the chunk.
+     * @param channelIndex The index of the channel.
+     * @param state The state of the channel.
+     * @param onEvent Callable as void (const Event&), which gets called for every run of at least minRunLength samples
+     * when it ends.
+     * @return True if a run reached minRunLength samples within this chunk, or false if not.
+     */
+    template <typename SampleType, typename EventCallback>
+    bool processChunk (
+        uint64_t mask,
+        const SampleType* chunk,
+        int const length,
+        int64_t const position,
+        int const channelIndex,
+        State& state,
+        EventCallback&& onEvent) const
+    {
+        jassert (length > 0 && length <= 64);
+
+        auto& run = state.run;
+
+        if (mask == 0 && run.runLength == 0)
+            return false; // Nothing clipped and no open run, which is by far the most common case.
+
+        bool clipped = false;
+        int pos = 0;
+
+        while (pos < length)
+        {
+            if (run.runLength == 0)
+            {
+                auto const remaining = mask >> pos;
+                if (remaining == 0)
+                    break;
+
+                // Open a new run at the next set bit.
+                pos += countTrailingZeros (remaining);
+                run = { channelIndex, position + pos, 0, 0.f, 1 };
+            }
+
+            // Extend the run with the consecutive set bits.
+            auto const numSet = juce::jmin (countTrailingZeros (~(mask >> pos)), length - pos);
+
+            for (int i = pos; i < pos + numSet; ++i)
+                run.peakLevel = juce::jmax (run.peakLevel, static_cast<float> (std::abs (chunk[i])));
+
+            run.runLength += numSet;
+            pos += numSet;
+
+            if (run.runLength >= mOptions.minRunLength)
+                clipped = true;
+
+            if (pos < length)
+            {
+                // The run ended within this chunk.
+                if (run.runLength >= mOptions.minRunLength)
+                    onEvent (run);
+                run.runLength = 0;
+            }
+        }
+
+        return clipped;
+    }
+
+private:
+    Options mOptions;
+
+    /**
+     * @return The number of trailing zero bits, or 64 if value is 0.
+     */
+    static int countTrailingZeros (uint64_t value)
+    {
+        if (value == 0)
+            return 64;
+
+#if JUCE_MSVC
+        unsigned long index;
+        _BitScanForward64 (&index, value);
+        return static_cast<int> (index);
+#else
+        return __builtin_ctzll (value);
+#endif
+    }
+};
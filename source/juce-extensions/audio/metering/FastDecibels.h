@@ -0,0 +1,329 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#if JUCE_USE_SSE_INTRINSICS
+    #include <emmintrin.h>
+#endif
+
+/**
+ * Fast approximations of juce::Decibels::gainToDecibels() and juce::Decibels::decibelsToGain(), for values which end up
+ * on a display. Conversions are done with log2 and exp2 approximations, which split a value into its exponent and
+ * mantissa and evaluate a short series for the mantissa:
+ * - log2 uses the atanh series on a mantissa in [sqrt(0.5), sqrt(2)), so the series argument stays below 0.172.
+ * - exp2 uses the exponential series on a fraction in [-0.5, 0.5].
+ *
+ * The number of terms depends on the sample type. The maximum error over -140..+20 dB is:
+ * - float: 3e-5 dB for gainToDecibels(), a relative error of 1e-6 for decibelsToGain().
+ * - double: 4e-12 dB for gainToDecibels(), a relative error of 2e-14 for decibelsToGain().
+ *
+ * Gains which are zero, negative, denormal or NaN map to minus infinity, just like with juce::Decibels. The batch
+ * functions use SSE2 for float, and convert double values one by one.
+ */
+class FastDecibels
+{
+public:
+    /**
+     * Approximates log2 (x) for finite, positive and normal values of x.
+     */
+    template <typename SampleType>
+    static SampleType log2 (SampleType x)
+    {
+        using Bits = SampleBits<SampleType>;
+
+        typename Bits::Type bits;
+        std::memcpy (&bits, &x, sizeof (bits));
+
+        // Split into exponent and mantissa, with the mantissa in [sqrt(0.5), sqrt(2)).
+        auto const offsetBits = bits - Bits::kSqrtHalf;
+        auto const exponent = static_cast<int> (static_cast<std::make_signed_t<typename Bits::Type>> (offsetBits)
+                                                >> Bits::kNumMantissaBits);
+        bits = (offsetBits & Bits::kMantissaMask) + Bits::kSqrtHalf;
+
+        SampleType mantissa;
+        std::memcpy (&mantissa, &bits, sizeof (mantissa));
+
+        return static_cast<SampleType> (exponent) + log2OfMantissa (mantissa);
+    }
+
+    /**
+     * Approximates 2^x. Results below the smallest normal value are flushed to zero.
+     */
+    template <typename SampleType>
+    static SampleType exp2 (SampleType x)
+    {
+        using Bits = SampleBits<SampleType>;
+
+        if (!(x >= Bits::kMinExponent)) // Also catches NaN.
+            return SampleType (0);
+
+        if (x > Bits::kMaxExponent)
+            return std::numeric_limits<SampleType>::infinity();
+
+        auto const exponent = std::floor (x + SampleType (0.5));
+        auto const fraction = x - exponent;
+
+        auto const exponentBits = static_cast<typename Bits::Type> (static_cast<int> (exponent) + Bits::kExponentBias)
+                                  << Bits::kNumMantissaBits;
+        SampleType scale;
+        std::memcpy (&scale, &exponentBits, sizeof (scale));
+
+        return scale * exp2OfFraction (fraction);
+    }
+
+    /**
+     * Approximates juce::Decibels::gainToDecibels().
+     * @param gain The gain.
+     * @param minusInfinityDb The level in decibels which equals zero gain.
+     * @return The gain in decibels, or minusInfinityDb if the gain is below it.
+     */
+    template <typename SampleType>
+    static SampleType gainToDecibels (SampleType gain, SampleType minusInfinityDb)
+    {
+        if (!(gain >= std::numeric_limits<SampleType>::min()))
+            return minusInfinityDb;
+
+        if (gain > std::numeric_limits<SampleType>::max())
+            return gain;
+
+        return std::max (minusInfinityDb, log2 (gain) * kDecibelsPerOctave<SampleType>);
+    }
+
+    /**
+     * Approximates juce::Decibels::decibelsToGain().
+     * @param decibels The level in decibels.
+     * @param minusInfinityDb The level in decibels which equals zero gain.
+     * @return The gain, or zero if decibels is at or below minusInfinityDb.
+     */
+    template <typename SampleType>
+    static SampleType decibelsToGain (SampleType decibels, SampleType minusInfinityDb)
+    {
+        return decibels > minusInfinityDb ? exp2 (decibels * kOctavesPerDecibel<SampleType>) : SampleType (0);
+    }
+
+    /**
+     * Converts a number of gains to decibels, see gainToDecibels().
+     * @param gains The gains.
+     * @param decibels Receives the levels in decibels, must hold numValues values. May be the same as gains.
+     * @param numValues The number of values.
+     * @param minusInfinityDb The level in decibels which equals zero gain.
+     */
+    template <typename SampleType>
+    static void gainsToDecibels (
+        const SampleType* gains,
+        SampleType* decibels,
+        int numValues,
+        SampleType minusInfinityDb)
+    {
+        int i = 0;
+
+#if JUCE_USE_SSE_INTRINSICS
+        if constexpr (std::is_same_v<SampleType, float>)
+            i = gainsToDecibelsSSE (gains, decibels, numValues, minusInfinityDb);
+#endif
+
+        for (; i < numValues; ++i)
+            decibels[i] = gainToDecibels (gains[i], minusInfinityDb);
+    }
+
+    /**
+     * Converts a number of levels in decibels to gains, see decibelsToGain().
+     * @param decibels The levels in decibels.
+     * @param gains Receives the gains, must hold numValues values. May be the same as decibels.
+     * @param numValues The number of values.
+     * @param minusInfinityDb The level in decibels which equals zero gain.
+     */
+    template <typename SampleType>
+    static void decibelsToGains (
+        const SampleType* decibels,
+        SampleType* gains,
+        int numValues,
+        SampleType minusInfinityDb)
+    {
+        int i = 0;
+
+#if JUCE_USE_SSE_INTRINSICS
+        if constexpr (std::is_same_v<SampleType, float>)
+            i = decibelsToGainsSSE (decibels, gains, numValues, minusInfinityDb);
+#endif
+
+        for (; i < numValues; ++i)
+            gains[i] = decibelsToGain (decibels[i], minusInfinityDb);
+    }
+
+private:
+    /// 20 * log10 (2).
+    template <typename SampleType>
+    static constexpr SampleType kDecibelsPerOctave = SampleType (6.0205999132796239);
+
+    /// 1 / (20 * log10 (2)).
+    template <typename SampleType>
+    static constexpr SampleType kOctavesPerDecibel = SampleType (0.16609640474436813);
+
+    /// The bit layout of IEEE 754 values.
+    template <typename SampleType>
+    struct SampleBits
+    {
+        static_assert (std::is_same_v<SampleType, float> || std::is_same_v<SampleType, double>);
+        static constexpr bool kIsFloat = std::is_same_v<SampleType, float>;
+
+        using Type = std::conditional_t<kIsFloat, uint32_t, uint64_t>;
+        static constexpr int kNumMantissaBits = kIsFloat ? 23 : 52;
+        static constexpr int kExponentBias = kIsFloat ? 127 : 1023;
+        static constexpr Type kMantissaMask = (Type (1) << kNumMantissaBits) - 1;
+        static constexpr Type kSqrtHalf = kIsFloat ? Type (0x3f3504f3) : Type (0x3fe6a09e667f3bcd);
+        static constexpr SampleType kMinExponent = SampleType (1 - kExponentBias);
+        static constexpr SampleType kMaxExponent = SampleType (kExponentBias);
+    };
+
+    /**
+     * log2 (m) = 2 / ln (2) * atanh (s), with s = (m - 1) / (m + 1). Terms up to s^5 for float and up to s^13 for
+     * double.
+     */
+    template <typename SampleType>
+    static SampleType log2OfMantissa (SampleType m)
+    {
+        auto const s = (m - SampleType (1)) / (m + SampleType (1));
+        auto const s2 = s * s;
+
+        SampleType series;
+        if constexpr (std::is_same_v<SampleType, float>)
+            series = 1.f + s2 * (1.f / 3.f + s2 * (1.f / 5.f));
+        else
+        {
+            series = 1.0 / 13.0;
+            for (auto const c : { 1.0 / 11.0, 1.0 / 9.0, 1.0 / 7.0, 1.0 / 5.0, 1.0 / 3.0, 1.0 })
+                series = c + s2 * series;
+        }
+
+        return SampleType (2.8853900817779268) * s * series;
+    }
+
+    /**
+     * 2^f = e^(f * ln (2)) for f in [-0.5, 0.5]. Terms up to degree 6 for float and up to degree 11 for double.
+     */
+    template <typename SampleType>
+    static SampleType exp2OfFraction (SampleType f)
+    {
+        auto const y = f * SampleType (0.69314718055994531);
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            auto result = 1.f / 720.f;
+            for (auto const c : { 1.f / 120.f, 1.f / 24.f, 1.f / 6.f, 1.f / 2.f, 1.f, 1.f })
+                result = c + y * result;
+            return result;
+        }
+        else
+        {
+            auto result = 1.0 / 39916800.0;
+            for (auto const c : { 1.0 / 3628800.0,
+                                  1.0 / 362880.0,
+                                  1.0 / 40320.0,
+                                  1.0 / 5040.0,
+                                  1.0 / 720.0,
+                                  1.0 / 120.0,
+                                  1.0 / 24.0,
+                                  1.0 / 6.0,
+                                  1.0 / 2.0,
+                                  1.0,
+                                  1.0 })
+                result = c + y * result;
+            return result;
+        }
+    }
+
+#if JUCE_USE_SSE_INTRINSICS
+    /**
+     * Converts groups of 4 gains using SSE2.
+     * @return The number of converted values.
+     */
+    static int gainsToDecibelsSSE (const float* gains, float* decibels, int numValues, float minusInfinityDb)
+    {
+        auto const minNormal = _mm_set1_ps (std::numeric_limits<float>::min());
+        auto const sqrtHalf = _mm_set1_epi32 (0x3f3504f3);
+        auto const mantissaMask = _mm_set1_epi32 (0x007fffff);
+        auto const one = _mm_set1_ps (1.f);
+        auto const vMinusInfinity = _mm_set1_ps (minusInfinityDb);
+
+        int i = 0;
+        for (; i + 4 <= numValues; i += 4)
+        {
+            auto const gain = _mm_loadu_ps (gains + i);
+            auto const isNormal = _mm_cmpge_ps (gain, minNormal); // False for zero, negative, denormal and NaN.
+
+            auto const offsetBits = _mm_sub_epi32 (_mm_castps_si128 (gain), sqrtHalf);
+            auto const exponent = _mm_cvtepi32_ps (_mm_srai_epi32 (offsetBits, 23));
+            auto const m = _mm_castsi128_ps (_mm_add_epi32 (_mm_and_si128 (offsetBits, mantissaMask), sqrtHalf));
+
+            auto const s = _mm_div_ps (_mm_sub_ps (m, one), _mm_add_ps (m, one));
+            auto const s2 = _mm_mul_ps (s, s);
+            auto series = _mm_add_ps (_mm_set1_ps (1.f / 3.f), _mm_mul_ps (s2, _mm_set1_ps (1.f / 5.f)));
+            series = _mm_add_ps (one, _mm_mul_ps (s2, series));
+
+            auto const log2OfMantissa = _mm_mul_ps (_mm_mul_ps (_mm_set1_ps (2.8853900817779268f), s), series);
+            auto const log2 = _mm_add_ps (exponent, log2OfMantissa);
+            auto const db = _mm_max_ps (_mm_mul_ps (log2, _mm_set1_ps (kDecibelsPerOctave<float>)), vMinusInfinity);
+
+            // Infinite gains keep their (infinite) value, like the scalar version.
+            auto const isInfinite = _mm_cmpgt_ps (gain, _mm_set1_ps (std::numeric_limits<float>::max()));
+            auto const result = _mm_or_ps (_mm_andnot_ps (isInfinite, db), _mm_and_ps (isInfinite, gain));
+
+            _mm_storeu_ps (
+                decibels + i,
+                _mm_or_ps (_mm_and_ps (isNormal, result), _mm_andnot_ps (isNormal, vMinusInfinity)));
+        }
+
+        return i;
+    }
+
+    /**
+     * Converts groups of 4 levels in decibels using SSE2.
+     * @return The number of converted values.
+     */
+    static int decibelsToGainsSSE (const float* decibels, float* gains, int numValues, float minusInfinityDb)
+    {
+        auto const vMinusInfinity = _mm_set1_ps (minusInfinityDb);
+        auto const minExponent = _mm_set1_ps (SampleBits<float>::kMinExponent);
+        auto const maxExponent = _mm_set1_ps (SampleBits<float>::kMaxExponent);
+        auto const bias = _mm_set1_epi32 (SampleBits<float>::kExponentBias);
+
+        int i = 0;
+        for (; i + 4 <= numValues; i += 4)
+        {
+            auto const db = _mm_loadu_ps (decibels + i);
+            auto const x = _mm_mul_ps (db, _mm_set1_ps (kOctavesPerDecibel<float>));
+            auto const isAudible = _mm_and_ps (_mm_cmpgt_ps (db, vMinusInfinity), _mm_cmpge_ps (x, minExponent));
+
+            // Round to nearest, so the fraction lies in [-0.5, 0.5].
+            auto const clamped = _mm_min_ps (_mm_max_ps (x, minExponent), maxExponent);
+            auto const exponent = _mm_cvtps_epi32 (clamped);
+            auto const y = _mm_mul_ps (_mm_sub_ps (clamped, _mm_cvtepi32_ps (exponent)), _mm_set1_ps (0.69314718f));
+
+            auto p = _mm_set1_ps (1.f / 720.f);
+            for (auto const c : { 1.f / 120.f, 1.f / 24.f, 1.f / 6.f, 1.f / 2.f, 1.f, 1.f })
+                p = _mm_add_ps (_mm_set1_ps (c), _mm_mul_ps (y, p));
+
+            auto const scale = _mm_castsi128_ps (_mm_slli_epi32 (_mm_add_epi32 (exponent, bias), 23));
+            auto gain = _mm_mul_ps (scale, p);
+
+            // Above the largest exponent, the result is infinite like the scalar version.
+            auto const isOverflow = _mm_cmpgt_ps (x, maxExponent);
+            gain = _mm_or_ps (
+                _mm_andnot_ps (isOverflow, gain),
+                _mm_and_ps (isOverflow, _mm_set1_ps (std::numeric_limits<float>::infinity())));
+
+            _mm_storeu_ps (gains + i, _mm_and_ps (isAudible, gain));
+        }
+
+        return i;
+    }
+#endif
+};
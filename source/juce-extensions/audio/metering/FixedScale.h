@@ -0,0 +1,150 @@
+#pragma once
+
+#include "LevelMeterConstants.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+/**
+ * A scale of which the divisions are known at compile time. All mapping functions are static and (where the standard
+ * library allows it) constexpr, and loop over a fixed number of divisions, so compilers can fold them into straight
+ * line code and inline them at the call site. A FixedScale needs no setup at runtime.
+ *
+ * The divisions are given by a definition type, for example:
+ *
+ * @code
+ * struct MyScaleDefinition
+ * {
+ *     static constexpr double kMinusInfinityDb = -60.0;
+ *     static constexpr std::array<double, 4> kDivisions { -60.0, -40.0, -20.0, 0.0 };
+ * };
+ *
+ * using MyScale = FixedScale<MyScaleDefinition>;
+ * @endcode
+ *
+ * LevelMeter::Scale can be constructed from a FixedScale, for code which takes a scale at runtime. That scale maps with
+ * its own lookup table, so only code which uses a FixedScale directly (like FixedScaledSlider) gets the inlined
+ * mapping.
+ * @tparam Definition The type which defines kMinusInfinityDb and kDivisions, ordered from low to high.
+ */
+template <class Definition>
+class FixedScale
+{
+public:
+    /// The number of divisions of this scale.
+    static constexpr size_t kNumDivisions = std::size (Definition::kDivisions);
+
+    static_assert (kNumDivisions >= 2, "A scale needs at least two divisions.");
+    static_assert (
+        [] {
+            for (size_t i = 1; i < kNumDivisions; ++i)
+                if (!(Definition::kDivisions[i] > Definition::kDivisions[i - 1]))
+                    return false;
+            return true;
+        }(),
+        "The divisions of a scale must be strictly increasing.");
+
+    /**
+     * Calculates the proportion [0.0, 1.0] for given level.
+     * @param level The level [-1.0, 1.0].
+     * @return The proportion for given level.
+     */
+    static double calculateProportionForLevel (double level)
+    {
+        auto const levelDb = level > 0.0 ? std::log10 (level) * 20.0 : Definition::kMinusInfinityDb;
+        return calculateProportionForLevelDb (levelDb > Definition::kMinusInfinityDb ? levelDb
+                                                                                     : Definition::kMinusInfinityDb);
+    }
+
+    /**
+     * Calculates the proportion [0.0, 1.0] for given level.
+     * @param levelDb The level in decibels.
+     * @return The proportion for given level.
+     */
+    static constexpr double calculateProportionForLevelDb (double levelDb)
+    {
+        if (levelDb <= Definition::kDivisions.front())
+            return 0.0;
+
+        if (levelDb >= Definition::kDivisions.back())
+            return 1.0;
+
+        for (size_t i = 1; i < kNumDivisions; ++i)
+        {
+            if (levelDb <= Definition::kDivisions[i])
+            {
+                auto const low = Definition::kDivisions[i - 1];
+                auto const divisionProportion = (levelDb - low) / (Definition::kDivisions[i] - low);
+                return (static_cast<double> (i - 1) + divisionProportion) * kProportionPerDivision;
+            }
+        }
+
+        return 1.0; // Fallback
+    }
+
+    /**
+     * Calculates the level in decibels for given proportion.
+     * @param proportion The proportion [0.0, 1.0].
+     * @return The level in decibels for given proportion.
+     */
+    static constexpr double calculateLevelDbForProportion (double proportion)
+    {
+        if (proportion <= 0.0)
+            return Definition::kDivisions.front();
+
+        if (proportion >= 1.0)
+            return Definition::kDivisions.back();
+
+        auto const position = proportion / kProportionPerDivision;
+        auto const index = std::min (static_cast<size_t> (position), kNumDivisions - 2);
+        auto const low = Definition::kDivisions[index];
+
+        return low + (position - static_cast<double> (index)) * (Definition::kDivisions[index + 1] - low);
+    }
+
+    /**
+     * @return The divisions of this scale.
+     */
+    static constexpr const auto& getDivisions()
+    {
+        return Definition::kDivisions;
+    }
+
+    /**
+     * @return Minus infinity in decibels.
+     */
+    static constexpr double getMinusInfinityDb()
+    {
+        return Definition::kMinusInfinityDb;
+    }
+
+private:
+    static constexpr double kProportionPerDivision = 1.0 / static_cast<double> (kNumDivisions - 1);
+};
+
+/**
+ * The definition of the default scale of a level meter.
+ */
+struct DefaultScaleDefinition
+{
+    static constexpr double kMinusInfinityDb = LevelMeterConstants::kDefaultMinusInfinityDb;
+
+    static constexpr std::array<double, 13> kDivisions { LevelMeterConstants::kDefaultMinusInfinityDb,
+                                                         -80.0,
+                                                         -60.0,
+                                                         -40.0,
+                                                         -30.0,
+                                                         -24.0,
+                                                         -20.0,
+                                                         -16.0,
+                                                         -12.0,
+                                                         -9.0,
+                                                         -6.0,
+                                                         -3.0,
+                                                         0.0 };
+};
+
+/// The default scale of a level meter, which is available without any setup at runtime.
+using DefaultFixedScale = FixedScale<DefaultScaleDefinition>;
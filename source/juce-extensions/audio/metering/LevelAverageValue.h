@@ -0,0 +1,108 @@
+#pragma once
+
+#include "LevelMeterConstants.h"
+
+#include <cstdint>
+#include <juce_core/juce_core.h>
+
+/**
+ * Little class which keeps a windowed average of a value over time. Block averages are added weighted by their number
+ * of samples, and are integrated with an exponential window of a configurable integration time. Ideal for values like
+ * DC offset or mean square, which should be steady on a meter.
+ * @tparam SampleType The type of the sample to use. Probably float or double.
+ */
+template <class SampleType>
+class LevelAverageValue
+{
+public:
+    LevelAverageValue() = default;
+
+    /**
+     * Sets the integration time, which is the time constant of the exponential window.
+     * @param integrationTimeMs The integration time in milliseconds.
+     */
+    void setIntegrationTime (uint32_t const integrationTimeMs)
+    {
+        mIntegrationTimeMs = integrationTimeMs;
+    }
+
+    /**
+     * Adds the average of a block.
+     * @param average The average value of the block.
+     * @param numSamples The number of samples in the block.
+     */
+    void addBlock (SampleType average, int numSamples)
+    {
+        mSum += average * static_cast<SampleType> (numSamples);
+        mNumSamples += numSamples;
+    }
+
+    /**
+     * Gets the next value to show on a meter. All blocks which were added since the previous call are integrated over
+     * the time since the previous call using a monotonic system clock.
+     * @return The value for this point in time.
+     */
+    SampleType getNextValue()
+    {
+        auto const deltaTime = getDeltaTime();
+
+        if (mNumSamples > 0)
+        {
+            auto const average = mSum / static_cast<SampleType> (mNumSamples);
+
+            if (!mHasValue || mIntegrationTimeMs == 0)
+                mValue = average;
+            else
+                mValue += (average - mValue) * static_cast<SampleType> (
+                              1.0 - std::exp (-static_cast<double> (deltaTime) / mIntegrationTimeMs));
+
+            mHasValue = true;
+            mSum = {};
+            mNumSamples = 0;
+        }
+
+        return mValue;
+    }
+
+    /**
+     * Resets this value to zero.
+     */
+    void reset()
+    {
+        mValue = {};
+        mSum = {};
+        mNumSamples = 0;
+        mHasValue = false;
+        mPreviousTime = {};
+    }
+
+private:
+    /// The time constant of the exponential window.
+    uint32_t mIntegrationTimeMs { LevelMeterConstants::kDefaultIntegrationTimeMs };
+
+    /// The current integrated value.
+    SampleType mValue { 0.0 };
+
+    /// The weighted sum of the blocks added since the previous call to getNextValue().
+    SampleType mSum { 0.0 };
+
+    /// The number of samples added since the previous call to getNextValue().
+    int64_t mNumSamples { 0 };
+
+    /// True if the value was set at least once.
+    bool mHasValue { false };
+
+    /// Used for finding the time since the previous call to DeltaTime().
+    uint32_t mPreviousTime { 0 };
+
+    /**
+     * @return The amount of time (in milliseconds) since the previous call to this method.
+     */
+    uint32_t getDeltaTime()
+    {
+        auto currentTime = juce::Time::getMillisecondCounter();
+        auto deltaTime = currentTime - mPreviousTime;
+        mPreviousTime = currentTime;
+        return deltaTime;
+    }
+};
@@ -1,20 +1,203 @@
 #include "LevelMeter.h"
 
-LevelMeter::LevelMeter()
+#include <cstring>
+#include <limits>
+
+namespace
+{
+
+/// The time the shared timer may spend refreshing meters per tick. Guarded by LevelMeter::getProcessingLock().
+double gRefreshTimeBudgetMs = LevelMeterConstants::kDefaultRefreshTimeBudgetMs;
+
+/// The statistics of all refreshes. Guarded by LevelMeter::getProcessingLock().
+LevelMeter::RefreshStatistics gRefreshStatistics;
+
+/**
+ * @return The default capacity of the measurement queue for given number of channels.
+ */
+size_t getDefaultMeasurementQueueCapacity (int const numChannels)
 {
-    mSharedTimer->subscribe (*this);
+    return LevelMeter::kDefaultBlocksPerRefresh * static_cast<size_t> (juce::jmax (1, numChannels));
+}
+
+} // namespace
+
+/**
+ * Subscription of a parent meter to a child meter, which forwards all measurements and overload events of the child to
+ * the parent. The channel data of the Subscriber base class is not used.
+ */
+class LevelMeter::ChildLink : public LevelMeter::Subscriber
+{
+public:
+    ChildLink (LevelMeter& parent, LevelMeter& child, std::vector<int> channelMap) :
+        Subscriber (Scale::getDefaultScale(), std::numeric_limits<int>::max()),
+        mParent (parent),
+        mChild (child),
+        mChannelMap (std::move (channelMap))
+    {
+        subscribeToLevelMeter (child);
+    }
+
+    ~ChildLink() override
+    {
+        unsubscribeFromLevelMeter();
+    }
+
+    [[nodiscard]] LevelMeter& getChild() const
+    {
+        return mChild;
+    }
+
+    /**
+     * @return The channel of the parent which given channel of the child maps to, or -1 if it's left out.
+     */
+    [[nodiscard]] int getParentChannelIndex (int const childChannelIndex) const
+    {
+        auto const numParentChannels = mParent.mPreparedToPlayInfo.numChannels;
+
+        if (childChannelIndex < 0 || numParentChannels <= 0)
+            return -1;
+
+        if (mChannelMap.empty())
+            return childChannelIndex % numParentChannels; // The default downmix, see addChildMeter().
+
+        if (!juce::isPositiveAndBelow (childChannelIndex, mChannelMap.size()))
+            return -1;
+
+        auto const parentChannelIndex = mChannelMap[static_cast<size_t> (childChannelIndex)];
+        return juce::isPositiveAndBelow (parentChannelIndex, numParentChannels) ? parentChannelIndex : -1;
+    }
+
+    void updateWithMeasurement (const Measurement& measurement) override
+    {
+        auto forwarded = measurement;
+        forwarded.channelIndex = getParentChannelIndex (measurement.channelIndex);
+
+        if (forwarded.channelIndex >= 0)
+            mParent.forwardChildMeasurement (forwarded);
+    }
+
+    void updateWithMeasurements (const Measurement* measurements, int const numMeasurements) override
+    {
+        for (int i = 0; i < numMeasurements; ++i)
+            ChildLink::updateWithMeasurement (measurements[i]);
+    }
+
+    void overloadEventOccurred (const OverloadEvent& event) override
+    {
+        auto forwarded = event;
+        forwarded.channelIndex = getParentChannelIndex (event.channelIndex);
+
+        if (forwarded.channelIndex >= 0)
+            mParent.forwardOverloadEvent (forwarded);
+    }
+
+private:
+    LevelMeter& mParent;
+    LevelMeter& mChild;
+
+    /// The channel of the parent for every channel of the child, or empty for the default downmix.
+    const std::vector<int> mChannelMap;
+
+    void levelMeterPrepared ([[maybe_unused]] int numChannels) override
+    {
+        // The number of channels of the child changed, which changes the sources of the channels of the parent.
+        mParent.mChildSourcesChanged = true;
+    }
+};
+
+LevelMeter::LevelMeter() : LevelMeter (0) {}
+
+LevelMeter::LevelMeter (size_t const measurementQueueCapacity) :
+    mHasDefaultQueueCapacity (measurementQueueCapacity == 0),
+    mMeasurements (
+        mHasDefaultQueueCapacity ? getDefaultMeasurementQueueCapacity (mPreparedToPlayInfo.numChannels)
+                                 : measurementQueueCapacity)
+{
+    // prepareToPlay() only prepares these when the number of channels changes, so prepare the default layout here.
+    mOverloadStates.assign (static_cast<size_t> (mPreparedToPlayInfo.numChannels), {});
+    mInterleavedResults.resize (mOverloadStates.size());
+    mOverloadLog.prepare (mPreparedToPlayInfo.numChannels);
+
+    mSharedTimer->subscribe (*this, mRefreshGroup);
 }
 
 LevelMeter::~LevelMeter()
 {
+    const juce::ScopedLock lock (getProcessingLock());
+    mSharedTimerSubscription.reset(); // Make sure a refresh thread doesn't refresh this meter anymore.
+
+    // Parents and children keep references to this meter, remove them before they dangle.
+    while (!mParentMeters.empty())
+        mParentMeters.back()->detachChildMeter (*this);
+
+    while (!mChildLinks.empty())
+        detachChildMeter (mChildLinks.back()->getChild());
+
     mSubscribers.call ([] (Subscriber& s) {
         s.reset();
     });
 }
 
+LevelMeter::RefreshThread::RefreshThread()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+    mSharedTimer->addRefreshThread();
+}
+
+LevelMeter::RefreshThread::~RefreshThread()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+    mSharedTimer->removeRefreshThread();
+}
+
+juce::CriticalSection& LevelMeter::getProcessingLock()
+{
+    static juce::CriticalSection lock;
+    return lock;
+}
+
+LevelMeter::RefreshDriver::RefreshDriver (int const divisor)
+{
+    setDivisor (divisor);
+    mSharedTimer->addRefreshDriver (*this);
+}
+
+LevelMeter::RefreshDriver::~RefreshDriver()
+{
+    mSharedTimer->removeRefreshDriver (*this);
+}
+
+void LevelMeter::RefreshDriver::setDivisor (int const divisor)
+{
+    jassert (divisor >= 1);
+    mDivisor = juce::jmax (1, divisor);
+}
+
+void LevelMeter::RefreshDriver::refresh()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    if (++mNumCallsSinceRefresh < mDivisor)
+        return;
+
+    mNumCallsSinceRefresh = 0;
+    mSharedTimer->refresh (*this);
+}
+
 void LevelMeter::prepareToPlay (int numChannels)
 {
-    if (std::exchange (mPreparedToPlayInfo.numChannels, numChannels) != numChannels)
+    prepareToPlay (numChannels, mPreparedToPlayInfo.sampleRate);
+}
+
+void LevelMeter::prepareToPlay (int numChannels, double sampleRate)
+{
+    const juce::ScopedLock lock (getProcessingLock());
+
+    auto const sampleRateChanged = std::exchange (mPreparedToPlayInfo.sampleRate, sampleRate) != sampleRate;
+    auto const numChannelsChanged = std::exchange (mPreparedToPlayInfo.numChannels, numChannels) != numChannels;
+
+    if (numChannelsChanged)
     {
         mSubscribers.call ([numChannels] (Subscriber& s) {
             s.prepareToPlay (numChannels);
@@ -25,14 +208,295 @@ void LevelMeter::prepareToPlay (int numChannels)
         while (mMeasurements.pop())
         {
         };
+
+        // Resizing allocates, which is fine since audio processing is stopped.
+        if (mHasDefaultQueueCapacity)
+        {
+            auto const capacity = getDefaultMeasurementQueueCapacity (numChannels);
+            mMeasurements = moodycamel::ReaderWriterQueue<Measurement> (capacity);
+        }
+
+        while (mOverloadEvents.pop())
+        {
+        };
+
+        mChildMeasurements.clear();
+        mChildOverloadEvents.clear();
+        mChildSourcesChanged = true;
+
+        mOverloadStates.assign (static_cast<size_t> (juce::jmax (0, numChannels)), {});
+        mInterleavedResults.resize (mOverloadStates.size());
+        mSamplePosition = 0;
+        mOverloadLog.prepare (numChannels);
+        mHasPendingData.store (true, std::memory_order_release); // Give the prepared subscribers a first update.
+    }
+
+    if (numChannelsChanged || sampleRateChanged)
+        mHistory.prepare (numChannels, sampleRate, mHistoryOptions);
+}
+
+void LevelMeter::setHistoryOptions (const LevelMeterHistory::Options& options)
+{
+    // The history is written by the thread which refreshes the level meter.
+    const juce::ScopedLock lock (getProcessingLock());
+
+    mHistoryOptions = options;
+    mHistory.prepare (mPreparedToPlayInfo.numChannels, mPreparedToPlayInfo.sampleRate, mHistoryOptions);
+}
+
+const LevelMeterHistory& LevelMeter::getHistory() const
+{
+    return mHistory;
+}
+
+const LevelMeterOverloadLog& LevelMeter::getOverloadLog() const
+{
+    return mOverloadLog;
+}
+
+void LevelMeter::resetOverloadLog()
+{
+    const juce::ScopedLock lock (getProcessingLock());
+    mOverloadLog.reset();
+}
+
+void LevelMeter::setClipDetectorOptions (const ClipDetector::Options& options)
+{
+    mClipDetectorOptions.store (options);
+}
+
+ClipDetector::Options LevelMeter::getClipDetectorOptions() const
+{
+    return mClipDetectorOptions.load();
+}
+
+int64_t LevelMeter::getNumDroppedMeasurements() const
+{
+    return mNumDroppedMeasurements.load (std::memory_order_relaxed);
+}
+
+int LevelMeter::getRefreshRateHz (RefreshGroup const group)
+{
+    switch (group)
+    {
+        case RefreshGroup::focused:
+            return LevelMeterConstants::kFocusedRefreshRateHz;
+        case RefreshGroup::overview:
+            return LevelMeterConstants::kOverviewRefreshRateHz;
+        case RefreshGroup::background:
+            return LevelMeterConstants::kBackgroundRefreshRateHz;
+        case RefreshGroup::normal:
+            break;
+    }
+
+    return LevelMeterConstants::kRefreshRateHz;
+}
+
+void LevelMeter::setRefreshTimeBudgetMs (double const budgetMs)
+{
+    jassert (budgetMs >= 0.0);
+
+    const juce::ScopedLock lock (getProcessingLock());
+    gRefreshTimeBudgetMs = juce::jmax (0.0, budgetMs);
+}
+
+double LevelMeter::getRefreshTimeBudgetMs()
+{
+    const juce::ScopedLock lock (getProcessingLock());
+    return gRefreshTimeBudgetMs;
+}
+
+LevelMeter::RefreshStatistics LevelMeter::getRefreshStatistics()
+{
+    const juce::ScopedLock lock (getProcessingLock());
+    return gRefreshStatistics;
+}
+
+void LevelMeter::resetRefreshStatistics()
+{
+    const juce::ScopedLock lock (getProcessingLock());
+    gRefreshStatistics = {};
+}
+
+void LevelMeter::SharedTimer::refreshLevelMeters()
+{
+    // Every caller holds the processing lock, which also guards the budget and the statistics. The refresh thread
+    // updates the statistics while the message thread reads them.
+    auto const startMs = juce::Time::getMillisecondCounterHiRes();
+    auto const deadlineMs = gRefreshTimeBudgetMs > 0.0 ? startMs + gRefreshTimeBudgetMs
+                                                       : std::numeric_limits<double>::infinity();
+
+    startDueRounds();
+
+    bool hasBudgetLeft = true;
+    bool mustRefreshOne = true; // Makes sure every tick makes progress, however small the budget.
+
+    for (auto& group : mGroups)
+    {
+        if (group.numMetersLeft == 0)
+            continue;
+
+        hasBudgetLeft = refreshGroup (group, deadlineMs, mustRefreshOne);
+
+        if (!hasBudgetLeft)
+            break;
+    }
+
+    auto const durationMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+
+    gRefreshStatistics.numTicks++;
+    gRefreshStatistics.lastTickDurationMs = durationMs;
+    gRefreshStatistics.maxTickDurationMs = juce::jmax (gRefreshStatistics.maxTickDurationMs, durationMs);
+
+    if (!hasBudgetLeft)
+    {
+        gRefreshStatistics.numTicksOverBudget++;
+
+        for (auto& group : mGroups)
+            gRefreshStatistics.numMetersCarriedOver += static_cast<int64_t> (group.numMetersLeft);
+    }
+}
+
+bool LevelMeter::SharedTimer::refreshGroup (Group& group, double const deadlineMs, bool& mustRefreshOne)
+{
+    auto const numMeters = static_cast<size_t> (group.levelMeters.get_num_subscribers());
+
+    // Meters might have been removed since the round started.
+    group.numMetersLeft = std::min (group.numMetersLeft, numMeters);
+    if (group.nextMeterIndex >= numMeters)
+        group.nextMeterIndex = 0;
+
+    auto const firstIndex = group.nextMeterIndex;
+    bool hasBudgetLeft = true;
+
+    auto const refreshRange = [&] (size_t const begin, size_t const end) {
+        size_t index = 0;
+
+        group.levelMeters.call ([&] (LevelMeter& levelMeter) {
+            auto const i = index++;
+
+            if (i < begin || i >= end || group.numMetersLeft == 0 || !hasBudgetLeft)
+                return;
+
+            if (!mustRefreshOne && juce::Time::getMillisecondCounterHiRes() >= deadlineMs)
+            {
+                hasBudgetLeft = false;
+                return;
+            }
+
+            mustRefreshOne = false;
+            group.isRoundActive = levelMeter.refresh() || group.isRoundActive;
+            group.nextMeterIndex = i + 1;
+            group.numMetersLeft--;
+        });
+    };
+
+    refreshRange (firstIndex, numMeters);
+    refreshRange (0, firstIndex);
+
+    if (group.numMetersLeft == 0)
+        group.isIdle = !group.isRoundActive;
+
+    return hasBudgetLeft;
+}
+
+void LevelMeter::setRefreshGroup (RefreshGroup const group)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    if (group == mRefreshGroup)
+        return;
+
+    mRefreshGroup = group;
+    mSharedTimer->subscribe (*this, group);
+}
+
+LevelMeter::RefreshGroup LevelMeter::getRefreshGroup() const
+{
+    return mRefreshGroup;
+}
+
+void LevelMeter::addChildMeter (LevelMeter& child)
+{
+    addChildMeter (child, {});
+}
+
+void LevelMeter::addChildMeter (LevelMeter& child, std::vector<int> channelMap)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+    jassert (&child != this); // A meter can't aggregate itself.
+
+    const juce::ScopedLock lock (getProcessingLock());
+    mChildLinks.push_back (std::make_unique<ChildLink> (*this, child, std::move (channelMap)));
+    child.mParentMeters.push_back (this);
+    mChildSourcesChanged = true;
+}
+
+void LevelMeter::removeChildMeter (LevelMeter& child)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    const juce::ScopedLock lock (getProcessingLock());
+    detachChildMeter (child);
+}
+
+void LevelMeter::detachChildMeter (LevelMeter& child)
+{
+    mChildLinks.erase (
+        std::remove_if (
+            mChildLinks.begin(),
+            mChildLinks.end(),
+            [&child] (const auto& link) {
+                return &link->getChild() == &child;
+            }),
+        mChildLinks.end());
+    child.mParentMeters.erase (
+        std::remove (child.mParentMeters.begin(), child.mParentMeters.end(), this),
+        child.mParentMeters.end());
+    mChildSourcesChanged = true;
+}
+
+void LevelMeter::updateChildSources()
+{
+    if (!mChildSourcesChanged)
+        return;
+
+    mChildSourcesChanged = false;
+
+    auto const numChannels = static_cast<size_t> (juce::jmax (0, mPreparedToPlayInfo.numChannels));
+    mNumChildSources.assign (numChannels, 0);
+    mChildSampleCounts.resize (numChannels, 0);
+
+    for (auto const& link : mChildLinks)
+    {
+        for (int ch = 0; ch < link->getChild().mPreparedToPlayInfo.numChannels; ++ch)
+        {
+            auto const parentChannelIndex = link->getParentChannelIndex (ch);
+            if (parentChannelIndex >= 0)
+                mNumChildSources[static_cast<size_t> (parentChannelIndex)]++;
+        }
     }
 }
 
+bool LevelMeter::poll()
+{
+    const juce::ScopedLock lock (getProcessingLock());
+    return refresh();
+}
+
+void LevelMeter::pollAll()
+{
+    juce::SharedResourcePointer<SharedTimer> sharedTimer;
+    sharedTimer->poll();
+}
+
 rdk::Subscription LevelMeter::subscribe (Subscriber* subscriber)
 {
     if (subscriber == nullptr)
         return {};
+    const juce::ScopedLock lock (getProcessingLock());
     subscriber->prepareToPlay (mPreparedToPlayInfo.numChannels);
+    mIsSettled = false; // Give the new subscriber a first update.
     return mSubscribers.add (subscriber);
 }
 
@@ -52,39 +516,450 @@ void LevelMeter::measureBlock (const SampleType* const* inputChannelData, int nu
     jassert (numChannels >= 0);
     jassert (numSamples >= 0);
 
-    // Measure levels
+    retryPendingOverloadEvents();
+    measureChannels (inputChannelData, numChannels, numSamples, 0);
+    finishBlock (numSamples);
+}
+
+// Trigger symbol generation.
+template void LevelMeter::measureBlock (const float* const* inputChannelData, int numChannels, int numSamples);
+template void LevelMeter::measureBlock (const double* const* inputChannelData, int numChannels, int numSamples);
+
+void LevelMeter::finishBlock (int const numSamples)
+{
+    mSamplePosition += numSamples;
+    mHasPendingData.store (true, std::memory_order_release);
+}
+
+void LevelMeter::retryPendingOverloadEvents()
+{
+    for (auto& state : mOverloadStates)
+    {
+        if (state.hasPendingEvent && mOverloadEvents.try_enqueue (state.pendingEvent))
+            state.hasPendingEvent = false;
+    }
+}
+
+template <typename SampleType>
+void LevelMeter::measureBlock (
+    const SampleType* const* inputChannelData,
+    const int* channelMap,
+    int const numChannels,
+    int const startSample,
+    int const numSamples)
+{
+    jassert (numChannels >= 0);
+    jassert (startSample >= 0);
+    jassert (numSamples >= 0);
+
+    retryPendingOverloadEvents();
+
+    const ClipDetector clipDetector (mClipDetectorOptions.load());
+
+    for (int ch = 0; ch < numChannels; ch++)
+        measureChannel (inputChannelData[channelMap[ch]] + startSample, numSamples, ch, clipDetector);
+
+    finishBlock (numSamples);
+}
+
+// Trigger symbol generation.
+template void LevelMeter::measureBlock (const float* const*, const int*, int, int, int);
+template void LevelMeter::measureBlock (const double* const*, const int*, int, int, int);
+
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+template <typename SampleType>
+void LevelMeter::measureBlock (const juce::dsp::AudioBlock<const SampleType>& block)
+{
+    auto const numChannels = static_cast<int> (block.getNumChannels());
+    auto const numSamples = static_cast<int> (block.getNumSamples());
+
+    retryPendingOverloadEvents();
+
+    const ClipDetector clipDetector (mClipDetectorOptions.load());
+
+    for (int ch = 0; ch < numChannels; ch++)
+        measureChannel (block.getChannelPointer (static_cast<size_t> (ch)), numSamples, ch, clipDetector);
+
+    finishBlock (numSamples);
+}
+
+// Trigger symbol generation.
+template void LevelMeter::measureBlock (const juce::dsp::AudioBlock<const float>& block);
+template void LevelMeter::measureBlock (const juce::dsp::AudioBlock<const double>& block);
+#endif
+
+void LevelMeter::measureInterleavedBlock (
+    const void* interleavedData,
+    int const numChannels,
+    int const numFrames,
+    PcmFormat const format)
+{
+    jassert (numChannels >= 0);
+    jassert (numFrames >= 0);
+
+    retryPendingOverloadEvents();
+
+    const ClipDetector clipDetector (mClipDetectorOptions.load());
+    auto const bytesPerSample = static_cast<size_t> (format.getBytesPerSample());
+    auto const frameStride = bytesPerSample * static_cast<size_t> (numChannels);
+    auto const* data = static_cast<const uint8_t*> (interleavedData);
+
+    // The prepared channels are measured together, in a single pass over the frames.
+    auto const numPreparedChannels = juce::jmin (numChannels, static_cast<int> (mOverloadStates.size()));
+    measureInterleavedChannels (data, frameStride, numPreparedChannels, numFrames, format, clipDetector);
+
+    // Channels which weren't prepared are measured one by one.
+    for (int ch = numPreparedChannels; ch < numChannels; ch++)
+    {
+        auto const* channelData = data + static_cast<size_t> (ch) * bytesPerSample;
+        measurePcmChannel (channelData, frameStride, numFrames, ch, format, clipDetector);
+    }
+
+    finishBlock (numFrames);
+}
+
+void LevelMeter::measurePlanarBlock (
+    const void* const* inputChannelData,
+    int const numChannels,
+    int const numSamples,
+    PcmFormat const format)
+{
+    jassert (numChannels >= 0);
+    jassert (numSamples >= 0);
+
+    retryPendingOverloadEvents();
+
+    const ClipDetector clipDetector (mClipDetectorOptions.load());
+    auto const stride = static_cast<size_t> (format.getBytesPerSample());
+
     for (int ch = 0; ch < numChannels; ch++)
     {
-        // Peak level
-        auto range = juce::FloatVectorOperations::findMinAndMax (inputChannelData[ch], numSamples);
-        auto peak = juce::jmax (range.getStart(), -range.getStart(), range.getEnd(), -range.getEnd());
+        // Native floats don't need decoding.
+        if (format.isNativeFloat())
+            measureChannel (static_cast<const float*> (inputChannelData[ch]), numSamples, ch, clipDetector);
+        else
+            measurePcmChannel (inputChannelData[ch], stride, numSamples, ch, format, clipDetector);
+    }
+
+    finishBlock (numSamples);
+}
+
+template <typename SampleType>
+void LevelMeter::measureChannels (
+    const SampleType* const* inputChannelData,
+    int const numChannels,
+    int const numSamples,
+    int const firstChannel)
+{
+    const ClipDetector clipDetector (mClipDetectorOptions.load());
+
+    for (int i = 0; i < numChannels; i++)
+        measureChannel (inputChannelData[i], numSamples, firstChannel + i, clipDetector);
+}
+
+// Trigger symbol generation.
+template void LevelMeter::measureChannels (const float* const*, int, int, int);
+template void LevelMeter::measureChannels (const double* const*, int, int, int);
+
+template <typename KernelFunction>
+void LevelMeter::measureChannelWith (
+    int const numSamples,
+    int const ch,
+    const ClipDetector& clipDetector,
+    KernelFunction&& kernel)
+{
+    auto* overloadState =
+        juce::isPositiveAndBelow (ch, mOverloadStates.size()) ? &mOverloadStates[static_cast<size_t> (ch)] : nullptr;
+    bool overloaded = false;
+
+    // A channel which wasn't prepared still honours the run length within the block, but doesn't log events.
+    ClipDetector::State unpreparedState;
+
+    auto onMask = [&] (uint64_t const mask, const auto* chunk, int const offset, int const length) {
+        if (overloadState == nullptr)
+        {
+            overloaded = clipDetector.processChunk (
+                             mask,
+                             chunk,
+                             length,
+                             mSamplePosition + offset,
+                             ch,
+                             unpreparedState,
+                             [] (const OverloadEvent&) {}) ||
+                         overloaded;
+            return;
+        }
+
+        overloaded = clipDetector.processChunk (
+                         mask,
+                         chunk,
+                         length,
+                         mSamplePosition + offset,
+                         ch,
+                         overloadState->clipState,
+                         [this] (const OverloadEvent& event) {
+                             pushOverloadEvent (event);
+                         }) ||
+                     overloaded;
+    };
+
+    // Peak level, mean, mean square, clip detection and invalid sample detection in a single pass.
+    auto const result = kernel (onMask);
+
+    pushMeasurement (ch, numSamples, result, overloaded);
+}
+
+void LevelMeter::measureInterleavedChannels (
+    const uint8_t* frames,
+    size_t const frameStride,
+    int const numChannels,
+    int const numFrames,
+    PcmFormat const format,
+    const ClipDetector& clipDetector)
+{
+    jassert (numChannels <= static_cast<int> (mOverloadStates.size()));
 
-        pushMeasurement ({ ch, peak });
+    // Integer samples can't exceed their largest code, so full scale codes count as clipped.
+    auto const threshold = juce::jmin (clipDetector.getOptions().threshold, format.getMaxLevel());
+
+    for (int ch = 0; ch < numChannels; ch++)
+        mOverloadStates[static_cast<size_t> (ch)].isBlockOverloaded = false;
+
+    auto onMask = [&] (int const ch, uint64_t const mask, const float* chunk, int const offset, int const length) {
+        auto& overloadState = mOverloadStates[static_cast<size_t> (ch)];
+
+        if (clipDetector.processChunk (
+                mask,
+                chunk,
+                length,
+                mSamplePosition + offset,
+                ch,
+                overloadState.clipState,
+                [this] (const OverloadEvent& event) {
+                    pushOverloadEvent (event);
+                }))
+        {
+            overloadState.isBlockOverloaded = true;
+        }
+    };
+
+    MeasurementKernel::measureInterleaved (
+        frames, frameStride, numChannels, numFrames, format, threshold, mInterleavedResults.data(), onMask);
+
+    for (int ch = 0; ch < numChannels; ch++)
+    {
+        auto const& overloadState = mOverloadStates[static_cast<size_t> (ch)];
+        pushMeasurement (ch, numFrames, mInterleavedResults[static_cast<size_t> (ch)], overloadState.isBlockOverloaded);
     }
 }
 
+void LevelMeter::pushMeasurement (
+    int const channelIndex,
+    int const numSamples,
+    const MeasurementKernel::Result& result,
+    bool const overloaded)
+{
+    pushMeasurement ({ channelIndex,
+                       result.peak,
+                       numSamples > 0 ? result.sum / numSamples : 0.0,
+                       numSamples > 0 ? result.sumSquares / numSamples : 0.0,
+                       numSamples,
+                       overloaded,
+                       result.numNaNs,
+                       result.numInfs,
+                       result.numDenormals });
+}
+
+template <typename SampleType>
+void LevelMeter::measureChannel (
+    const SampleType* channelData,
+    int const numSamples,
+    int const ch,
+    const ClipDetector& clipDetector)
+{
+    auto const threshold = static_cast<SampleType> (clipDetector.getOptions().threshold);
+
+    measureChannelWith (numSamples, ch, clipDetector, [&] (auto& onMask) {
+        return MeasurementKernel::measure (channelData, numSamples, threshold, onMask);
+    });
+}
+
 // Trigger symbol generation.
-template void LevelMeter::measureBlock (const float* const* inputChannelData, int numChannels, int numSamples);
-template void LevelMeter::measureBlock (const double* const* inputChannelData, int numChannels, int numSamples);
+template void LevelMeter::measureChannel (const float*, int, int, const ClipDetector&);
+template void LevelMeter::measureChannel (const double*, int, int, const ClipDetector&);
+
+void LevelMeter::measurePcmChannel (
+    const void* channelData,
+    size_t const stride,
+    int const numSamples,
+    int const ch,
+    PcmFormat const format,
+    const ClipDetector& clipDetector)
+{
+    // Integer samples can't exceed their largest code, so full scale codes count as clipped.
+    auto const threshold = juce::jmin (clipDetector.getOptions().threshold, format.getMaxLevel());
+
+    measureChannelWith (numSamples, ch, clipDetector, [&] (auto& onMask) {
+        return MeasurementKernel::measurePcm (channelData, stride, numSamples, format, threshold, onMask);
+    });
+}
 
 void LevelMeter::pushMeasurement (Measurement&& measurement)
 {
-    mMeasurements.enqueue (measurement);
+    // Never grow the queue, that would allocate on the audio thread.
+    if (!mMeasurements.try_enqueue (measurement))
+        mNumDroppedMeasurements.fetch_add (1, std::memory_order_relaxed);
+}
+
+void LevelMeter::forwardMeasurement (const Measurement& measurement, bool const addToHistory)
+{
+    if (addToHistory)
+    {
+        mHistory.addBlock (
+            measurement.channelIndex,
+            measurement.peakLevel,
+            measurement.meanSquare,
+            measurement.numSamples);
+    }
+
+    mChildMeasurements.push_back (measurement);
+    mHasPendingData.store (true, std::memory_order_release);
+}
+
+void LevelMeter::forwardChildMeasurement (const Measurement& measurement)
+{
+    updateChildSources();
+
+    auto const ch = static_cast<size_t> (measurement.channelIndex);
+    auto const numSources = static_cast<int64_t> (juce::jmax (1, mNumChildSources[ch]));
+
+    // Every source adds its share of the samples, so that the history keeps the pace of the sources. The samples which
+    // don't divide evenly are carried over to the next measurement.
+    auto& numSamples = mChildSampleCounts[ch];
+    numSamples += measurement.numSamples;
+    auto const share = numSamples / numSources;
+    numSamples -= share * numSources;
+
+    mHistory.addBlock (
+        measurement.channelIndex,
+        measurement.peakLevel,
+        measurement.meanSquare,
+        static_cast<int> (share));
+    forwardMeasurement (measurement, false);
+}
+
+void LevelMeter::forwardOverloadEvent (const OverloadEvent& event)
+{
+    mChildOverloadEvents.push_back (event);
+    mHasPendingData.store (true, std::memory_order_release);
 }
 
-void LevelMeter::timerCallback()
+void LevelMeter::pushOverloadEvent (const OverloadEvent& event)
 {
+    mHasPendingData.store (true, std::memory_order_release);
+
+    auto& state = mOverloadStates[static_cast<size_t> (event.channelIndex)];
+
+    if (state.hasPendingEvent)
+    {
+        if (!mOverloadEvents.try_enqueue (state.pendingEvent))
+        {
+            // Still no room, coalesce this event into the pending one.
+            state.pendingEvent.runLength += event.runLength;
+            state.pendingEvent.peakLevel = juce::jmax (state.pendingEvent.peakLevel, event.peakLevel);
+            state.pendingEvent.numRuns += event.numRuns;
+            return;
+        }
+
+        state.hasPendingEvent = false;
+    }
+
+    if (!mOverloadEvents.try_enqueue (event))
+    {
+        state.pendingEvent = event;
+        state.hasPendingEvent = true;
+    }
+}
+
+bool LevelMeter::refresh()
+{
+    // Clear the flag before draining, so that data pushed while draining makes the next refresh process it.
+    if (!mHasPendingData.exchange (false, std::memory_order_acquire) && mIsSettled)
+        return false;
+
+    bool hasActivity = false;
+
+    auto const addOverloadEvent = [this] (const OverloadEvent& event) {
+        mOverloadLog.addEvent (event);
+
+        mSubscribers.call ([&event] (Subscriber& s) {
+            s.overloadEventOccurred (event);
+        });
+    };
+
+    OverloadEvent overloadEvent;
+    while (mOverloadEvents.try_dequeue (overloadEvent))
+    {
+        hasActivity = true;
+        addOverloadEvent (overloadEvent);
+    }
+
+    for (auto& event : mChildOverloadEvents)
+    {
+        hasActivity = true;
+        addOverloadEvent (event);
+    }
+
+    mChildOverloadEvents.clear();
+
+    mDrainedMeasurements.clear();
+
     Measurement measurement;
     while (mMeasurements.try_dequeue (measurement))
     {
-        mSubscribers.call ([&measurement] (Subscriber& s) {
-            s.updateWithMeasurement (measurement);
+        hasActivity = hasActivity || isActive (measurement);
+        mHistory.addBlock (
+            measurement.channelIndex,
+            measurement.peakLevel,
+            measurement.meanSquare,
+            measurement.numSamples);
+        mDrainedMeasurements.push_back (measurement);
+    }
+
+    for (auto& childMeasurement : mChildMeasurements)
+    {
+        hasActivity = hasActivity || isActive (childMeasurement);
+        mDrainedMeasurements.push_back (childMeasurement);
+    }
+
+    mChildMeasurements.clear();
+
+    // Hand all measurements to every subscriber in one call, instead of calling every subscriber per measurement.
+    if (!mDrainedMeasurements.empty())
+    {
+        mSubscribers.call ([this] (Subscriber& s) {
+            s.updateWithMeasurements (mDrainedMeasurements.data(), static_cast<int> (mDrainedMeasurements.size()));
         });
     }
 
-    mSubscribers.call ([] (Subscriber& s) {
+    // Silence doesn't change anything for subscribers which have settled.
+    if (mIsSettled && !hasActivity)
+        return false;
+
+    bool isSettled = true;
+    mSubscribers.call ([&isSettled] (Subscriber& s) {
         s.measurementUpdatesFinished();
+        isSettled = isSettled && s.hasSettled();
     });
+
+    mIsSettled = isSettled;
+    return true;
+}
+
+bool LevelMeter::isActive (const Measurement& measurement)
+{
+    return measurement.peakLevel > 0.0 || measurement.overloaded || measurement.numNaNs > 0 || measurement.numInfs > 0
+           || measurement.numDenormals > 0;
 }
 
 void LevelMeter::Subscriber::prepareToPlay (int numChannels)
@@ -102,6 +977,11 @@ void LevelMeter::Subscriber::prepareToPlay (int numChannels)
         ch.peakHoldLevel.setMinusInfinityDb (mScale.getMinusInfinityDb());
         ch.peakHoldLevel.setPeakHoldTime (LevelMeterConstants::kPeakHoldDefaultValueTimeMs);
         ch.peakHoldLevel.setReturnRate (mReturnRateDbPerSecond);
+        ch.dcOffset.setIntegrationTime (mDcOffsetIntegrationTimeMs);
+        ch.meanSquare.setIntegrationTime (mCrestFactorIntegrationTimeMs);
+        ch.crestPeakLevel.setMinusInfinityDb (mScale.getMinusInfinityDb());
+        ch.crestPeakLevel.setPeakHoldTime (mCrestFactorIntegrationTimeMs);
+        ch.crestPeakLevel.setReturnRate (mReturnRateDbPerSecond);
     }
 
     levelMeterPrepared (numChannels);
@@ -132,11 +1012,25 @@ void LevelMeter::Subscriber::updateWithMeasurement (const Measurement& measureme
         }
     }
 
-    auto& [peakLevel, peakHoldLevel, overloaded] = mChannelData.getReference (channelIndex);
-    peakLevel.updateLevel (measurement.peakLevel);
-    peakHoldLevel.updateLevel (measurement.peakLevel);
-    if (measurement.peakLevel >= LevelMeterConstants::kOverloadTriggerLevel)
-        overloaded = true;
+    auto& channel = mChannelData.getReference (channelIndex);
+    channel.peakLevel.updateLevel (measurement.peakLevel);
+    channel.peakHoldLevel.updateLevel (measurement.peakLevel);
+    if (measurement.overloaded)
+        channel.overloaded = true;
+
+    channel.invalidSamples.numNaNs += measurement.numNaNs;
+    channel.invalidSamples.numInfs += measurement.numInfs;
+    channel.invalidSamples.numDenormals += measurement.numDenormals;
+
+    channel.dcOffset.addBlock (measurement.mean, measurement.numSamples);
+    channel.meanSquare.addBlock (measurement.meanSquare, measurement.numSamples);
+    channel.crestPeakLevel.updateLevel (measurement.peakLevel);
+}
+
+void LevelMeter::Subscriber::updateWithMeasurements (const Measurement* measurements, int const numMeasurements)
+{
+    for (int i = 0; i < numMeasurements; ++i)
+        updateWithMeasurement (measurements[i]);
 }
 
 void LevelMeter::Subscriber::subscribeToLevelMeter (LevelMeter& levelMeter)
@@ -144,6 +1038,13 @@ void LevelMeter::Subscriber::subscribeToLevelMeter (LevelMeter& levelMeter)
     setSubscription (levelMeter.subscribe (this));
 }
 
+bool LevelMeter::Subscriber::hasSettled() const
+{
+    return std::all_of (mChannelData.begin(), mChannelData.end(), [] (const ChannelData& ch) {
+        return ch.peakLevel.isSettled() && ch.peakHoldLevel.isSettled();
+    });
+}
+
 double LevelMeter::Subscriber::getPeakValue (int const channelIndex)
 {
     if (juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
@@ -158,6 +1059,26 @@ double LevelMeter::Subscriber::getPeakHoldValue (int const channelIndex)
     return 0.0;
 }
 
+void LevelMeter::Subscriber::catchUpPeak (int const channelIndex, double const peakLevel, uint32_t const ageMs)
+{
+    if (!juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
+        return;
+
+    auto& channel = mChannelData.getReference (channelIndex);
+    channel.peakLevel.catchUp (peakLevel, ageMs);
+    channel.peakHoldLevel.catchUp (peakLevel, ageMs);
+}
+
+double LevelMeter::Subscriber::getCaughtUpPeakHoldValue (
+    int const channelIndex,
+    double const peakLevel,
+    uint32_t const ageMs) const
+{
+    if (juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
+        return mChannelData.getReference (channelIndex).peakHoldLevel.getCaughtUpLevel (peakLevel, ageMs);
+    return peakLevel;
+}
+
 bool LevelMeter::Subscriber::isOverloaded (int const channelIndex) const
 {
     if (juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
@@ -171,6 +1092,31 @@ void LevelMeter::Subscriber::resetOverloaded()
         ch.overloaded = false;
 }
 
+LevelMeter::Subscriber::InvalidSampleCounts
+    LevelMeter::Subscriber::getInvalidSampleCounts (int const channelIndex) const
+{
+    if (juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
+        return mChannelData.getReference (channelIndex).invalidSamples;
+    return {};
+}
+
+bool LevelMeter::Subscriber::hasNonFiniteSamples (int const channelIndex) const
+{
+    auto const counts = getInvalidSampleCounts (channelIndex);
+    return counts.numNaNs > 0 || counts.numInfs > 0;
+}
+
+bool LevelMeter::Subscriber::hasDenormalSamples (int const channelIndex) const
+{
+    return getInvalidSampleCounts (channelIndex).numDenormals > 0;
+}
+
+void LevelMeter::Subscriber::resetInvalidSamples()
+{
+    for (auto& ch : mChannelData)
+        ch.invalidSamples = {};
+}
+
 const LevelMeter::Scale& LevelMeter::Subscriber::getScale() const
 {
     return mScale;
@@ -182,6 +1128,12 @@ LevelMeter::Subscriber::Subscriber (const Scale& scale, int const maxChannels) :
 {
 }
 
+LevelMeter::Subscriber::~Subscriber()
+{
+    const juce::ScopedLock lock (getProcessingLock());
+    mSubscription.reset();
+}
+
 int LevelMeter::Subscriber::getNumChannels() const
 {
     return mChannelData.size();
@@ -189,38 +1141,91 @@ int LevelMeter::Subscriber::getNumChannels() const
 
 void LevelMeter::Subscriber::setReturnRate (double const returnRateDbPerSecond)
 {
-    for (auto& [peakLevel, peakHoldLevel, overloaded] : mChannelData)
+    for (auto& ch : mChannelData)
     {
-        peakLevel.setReturnRate (returnRateDbPerSecond);
-        peakHoldLevel.setReturnRate (returnRateDbPerSecond);
+        ch.peakLevel.setReturnRate (returnRateDbPerSecond);
+        ch.peakHoldLevel.setReturnRate (returnRateDbPerSecond);
+        ch.crestPeakLevel.setReturnRate (returnRateDbPerSecond);
     }
 }
 
 void LevelMeter::Subscriber::setPeakHoldTimeMs (uint32_t const peakHoldTimeMs)
 {
-    for (auto& [peakLevel, peakHoldLevel, overloaded] : mChannelData)
-        peakHoldLevel.setPeakHoldTime (peakHoldTimeMs);
+    for (auto& ch : mChannelData)
+        ch.peakHoldLevel.setPeakHoldTime (peakHoldTimeMs);
+}
+
+double LevelMeter::Subscriber::getDcOffset (int const channelIndex)
+{
+    if (juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
+        return mChannelData.getReference (channelIndex).dcOffset.getNextValue();
+    return 0.0;
+}
+
+double LevelMeter::Subscriber::getCrestFactor (int const channelIndex)
+{
+    if (!juce::isPositiveAndBelow (channelIndex, mChannelData.size()))
+        return 0.0;
+
+    auto& channel = mChannelData.getReference (channelIndex);
+    auto const rms = std::sqrt (channel.meanSquare.getNextValue());
+    auto const peak = channel.crestPeakLevel.getNextLevel();
+
+    // Compares with the gain of minus infinity, rather than converting rms to decibels. Not using
+    // juce::Decibels::decibelsToGain() here, which returns 0 at minus infinity. Written so that NaN counts as silence.
+    auto const minusInfinityGain = std::pow (10.0, mScale.getMinusInfinityDb() * 0.05);
+    if (!(rms > minusInfinityGain))
+        return 0.0; // Silence.
+
+    return peak / rms;
+}
+
+void LevelMeter::Subscriber::setDcOffsetIntegrationTimeMs (uint32_t const integrationTimeMs)
+{
+    mDcOffsetIntegrationTimeMs = integrationTimeMs;
+
+    for (auto& ch : mChannelData)
+        ch.dcOffset.setIntegrationTime (integrationTimeMs);
+}
+
+void LevelMeter::Subscriber::setCrestFactorIntegrationTimeMs (uint32_t const integrationTimeMs)
+{
+    mCrestFactorIntegrationTimeMs = integrationTimeMs;
+
+    for (auto& ch : mChannelData)
+    {
+        ch.meanSquare.setIntegrationTime (integrationTimeMs);
+        ch.crestPeakLevel.setPeakHoldTime (integrationTimeMs);
+    }
 }
 
 void LevelMeter::Subscriber::unsubscribeFromLevelMeter()
 {
+    const juce::ScopedLock lock (getProcessingLock());
     mSubscription.reset();
     reset();
 }
 
 void LevelMeter::Subscriber::setSubscription (rdk::Subscription&& subscription)
 {
+    const juce::ScopedLock lock (getProcessingLock());
     mSubscription.reset();
     mSubscription = std::move (subscription);
 }
 
 void LevelMeter::Subscriber::reset()
 {
+    const juce::ScopedLock lock (getProcessingLock());
+
     for (auto& ch : mChannelData)
     {
         ch.peakLevel.reset();
         ch.peakHoldLevel.reset();
         ch.overloaded = false;
+        ch.invalidSamples = {};
+        ch.dcOffset.reset();
+        ch.meanSquare.reset();
+        ch.crestPeakLevel.reset();
     }
 
     measurementUpdatesFinished();
@@ -230,6 +1235,14 @@ LevelMeter::Scale::Scale (double minusInfinityDb, std::initializer_list<double>
     mMinusInfinityDb (minusInfinityDb),
     mDivisions (divisions)
 {
+    buildLookupTable();
+}
+
+LevelMeter::Scale::Scale (double minusInfinityDb, std::vector<double> divisions) :
+    mMinusInfinityDb (minusInfinityDb),
+    mDivisions (std::move (divisions))
+{
+    buildLookupTable();
 }
 
 const std::vector<double>& LevelMeter::Scale::getDivisions() const
@@ -239,7 +1252,80 @@ const std::vector<double>& LevelMeter::Scale::getDivisions() const
 
 double LevelMeter::Scale::calculateProportionForLevel (double level) const
 {
-    return calculateProportionForLevelDb (juce::Decibels::gainToDecibels (level, mMinusInfinityDb));
+    if (mLookupTable.empty())
+        return calculateProportionForLevelDb (FastDecibels::gainToDecibels (level, mMinusInfinityDb));
+
+    if (!(level > mLowestLevel)) // Also catches negative levels and NaN.
+        return mLowestProportion;
+
+    if (level >= mHighestLevel)
+        return mHighestProportion;
+
+    auto const& cell = mLookupTable[static_cast<size_t> (getLookupTableKey (level) - mLookupTableFirstKey)];
+
+    return level < cell.splitLevel ? cell.offsetBelowSplit + cell.slopeBelowSplit * level
+                                   : cell.offsetAboveSplit + cell.slopeAboveSplit * level;
+}
+
+void LevelMeter::Scale::calculateProportionsForLevels (const double* levels, double* proportions, int numValues) const
+{
+    jassert (numValues == 0 || (levels != nullptr && proportions != nullptr));
+
+    constexpr int kBlockSize = 64;
+
+    if (mLookupTable.empty())
+    {
+        // Without a table, convert each block to decibels in one batch for the exact mapping.
+        double levelsDb[kBlockSize];
+
+        for (int start = 0; start < numValues; start += kBlockSize)
+        {
+            auto const length = juce::jmin (kBlockSize, numValues - start);
+            FastDecibels::gainsToDecibels (levels + start, levelsDb, length, mMinusInfinityDb);
+
+            for (int i = 0; i < length; ++i)
+                proportions[start + i] = calculateProportionForLevelDb (levelsDb[i]);
+        }
+
+        return;
+    }
+
+    // Works in blocks, with separate passes for the arithmetic (which is branch free, so compilers can vectorize it)
+    // and for the table lookups.
+    double clampedLevels[kBlockSize];
+    uint32_t cellIndices[kBlockSize];
+
+    auto const* table = mLookupTable.data();
+
+    for (int start = 0; start < numValues; start += kBlockSize)
+    {
+        auto const length = juce::jmin (kBlockSize, numValues - start);
+
+        // Clamp into the range of the table, which also maps negative levels and NaN to the lowest level.
+        for (int i = 0; i < length; ++i)
+        {
+            auto const level = levels[start + i];
+            auto const clamped = level > mLowestLevel ? level : mLowestLevel;
+            clampedLevels[i] = clamped < mHighestLevel ? clamped : mHighestLevel;
+        }
+
+        for (int i = 0; i < length; ++i)
+            cellIndices[i] = static_cast<uint32_t> (getLookupTableKey (clampedLevels[i]) - mLookupTableFirstKey);
+
+        for (int i = 0; i < length; ++i)
+        {
+            auto const level = clampedLevels[i];
+            auto const& cell = table[cellIndices[i]];
+            auto const isBelowSplit = level < cell.splitLevel;
+            auto const offset = isBelowSplit ? cell.offsetBelowSplit : cell.offsetAboveSplit;
+            auto const slope = isBelowSplit ? cell.slopeBelowSplit : cell.slopeAboveSplit;
+            auto const proportion = offset + slope * level;
+
+            proportions[start + i] = level <= mLowestLevel    ? mLowestProportion
+                                     : level >= mHighestLevel ? mHighestProportion
+                                                              : proportion;
+        }
+    }
 }
 
 double LevelMeter::Scale::calculateProportionForLevelDb (double levelDb) const
@@ -256,17 +1342,15 @@ double LevelMeter::Scale::calculateProportionForLevelDb (double levelDb) const
     auto amountOfDivisions = static_cast<double> (mDivisions.size() - 1);
     auto proportionPerDivision = 1.0 / amountOfDivisions;
 
-    for (auto div = mDivisions.begin(); div != mDivisions.end(); ++div)
+    for (size_t i = 1; i < mDivisions.size(); ++i)
     {
-        if (levelDb <= *div)
+        if (levelDb <= mDivisions[i])
         {
-            auto i = std::distance (mDivisions.begin(), div);
-            double positionForStartOfCurrentDivision = static_cast<double> (i - 1) / amountOfDivisions;
-            auto decibelsForCurrentDivision = div == mDivisions.begin() ? 0.0 : *(div--) - *div;
-            auto decibelsIntoDivision = std::abs (levelDb - *div);
+            auto positionForStartOfCurrentDivision = static_cast<double> (i - 1) / amountOfDivisions;
+            auto decibelsForCurrentDivision = mDivisions[i] - mDivisions[i - 1];
+            auto decibelsIntoDivision = levelDb - mDivisions[i - 1];
             auto divisionProportion = decibelsIntoDivision / decibelsForCurrentDivision;
-            auto proportion = positionForStartOfCurrentDivision + proportionPerDivision * divisionProportion;
-            return proportion;
+            return positionForStartOfCurrentDivision + proportionPerDivision * divisionProportion;
         }
     }
 
@@ -304,21 +1388,110 @@ double LevelMeter::Scale::getMinusInfinityDb() const
     return mMinusInfinityDb;
 }
 
+double LevelMeter::Scale::getLookupTableMaxError() const
+{
+    return mLookupTableMaxError;
+}
+
+void LevelMeter::Scale::buildLookupTable()
+{
+    mLookupTable.clear();
+    mLookupTableMaxError = 0.0;
+
+    if (mDivisions.size() < 2)
+        return; // Nothing to interpolate, calculateProportionForLevel() uses the exact mapping.
+
+    auto const exactProportion = [this] (double level) {
+        return calculateProportionForLevelDb (juce::Decibels::gainToDecibels (level, mMinusInfinityDb));
+    };
+
+    // Note: not using juce::Decibels::decibelsToGain() here, which returns 0 at or below its minus infinity.
+    auto const decibelsToGain = [] (double decibels) {
+        return std::pow (10.0, decibels * 0.05);
+    };
+
+    mLowestLevel = decibelsToGain (juce::jmax (mDivisions.front(), mMinusInfinityDb));
+    mHighestLevel = decibelsToGain (mDivisions.back());
+    mLowestProportion = exactProportion (mLowestLevel);
+    mHighestProportion = 1.0;
+
+    if (!(mLowestLevel > 0.0) || !(mHighestLevel > mLowestLevel) || !std::isfinite (mHighestLevel))
+        return;
+
+    mLookupTableFirstKey = getLookupTableKey (mLowestLevel);
+    auto const lastKey = getLookupTableKey (mHighestLevel);
+    mLookupTable.resize (static_cast<size_t> (lastKey - mLookupTableFirstKey + 1));
+
+    auto const levelForKey = [] (uint64_t key) {
+        auto const bits = key << (52 - kLookupTableBitsPerOctave);
+        double level;
+        std::memcpy (&level, &bits, sizeof (level));
+        return level;
+    };
+
+    auto const makeSegment = [&exactProportion] (double start, double end, double& offset, double& slope) {
+        auto const startProportion = exactProportion (start);
+        slope = end > start ? (exactProportion (end) - startProportion) / (end - start) : 0.0;
+        offset = startProportion - slope * start;
+    };
+
+    for (size_t i = 0; i < mLookupTable.size(); ++i)
+    {
+        auto const key = mLookupTableFirstKey + i;
+        auto const start = juce::jmax (levelForKey (key), mLowestLevel);
+        auto const end = juce::jmin (levelForKey (key + 1), mHighestLevel);
+        auto& cell = mLookupTable[i];
+
+        // Split the cell at the division inside it, so that the kink of the mapping is exact.
+        cell.splitLevel = end;
+        int numDivisionsInCell = 0;
+        for (auto const division : mDivisions)
+        {
+            auto const divisionLevel = decibelsToGain (division);
+            if (divisionLevel > start && divisionLevel < end)
+            {
+                cell.splitLevel = divisionLevel;
+                ++numDivisionsInCell;
+            }
+        }
+
+        if (numDivisionsInCell > 1)
+        {
+            // Divisions are too close together for the table, fall back to the exact mapping.
+            mLookupTable.clear();
+            mLookupTableMaxError = 0.0;
+            return;
+        }
+
+        makeSegment (start, cell.splitLevel, cell.offsetBelowSplit, cell.slopeBelowSplit);
+        makeSegment (cell.splitLevel, end, cell.offsetAboveSplit, cell.slopeAboveSplit);
+
+        if (cell.splitLevel >= end)
+        {
+            cell.offsetAboveSplit = cell.offsetBelowSplit;
+            cell.slopeAboveSplit = cell.slopeBelowSplit;
+        }
+
+        // Measure the error at a number of points within the cell.
+        constexpr int kNumErrorProbes = 16;
+        for (int j = 0; j < kNumErrorProbes; ++j)
+        {
+            auto const level = start + (end - start) * (j + 0.5) / kNumErrorProbes;
+            auto const error = std::abs (calculateProportionForLevel (level) - exactProportion (level));
+            mLookupTableMaxError = juce::jmax (mLookupTableMaxError, error);
+        }
+    }
+}
+
+uint64_t LevelMeter::Scale::getLookupTableKey (double level)
+{
+    uint64_t bits;
+    std::memcpy (&bits, &level, sizeof (bits));
+    return bits >> (52 - kLookupTableBitsPerOctave);
+}
+
 const LevelMeter::Scale& LevelMeter::Scale::getDefaultScale()
 {
-    static const Scale scale { LevelMeterConstants::kDefaultMinusInfinityDb,
-                               { LevelMeterConstants::kDefaultMinusInfinityDb,
-                                 -80.0,
-                                 -60.0,
-                                 -40.0,
-                                 -30.0,
-                                 -24.0,
-                                 -20.0,
-                                 -16.0,
-                                 -12.0,
-                                 -9.0,
-                                 -6.0,
-                                 -3.0,
-                                 0.0 } };
+    static const Scale scale { DefaultFixedScale() };
     return scale;
 }
@@ -1,20 +1,55 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <vector>
 
+#include "ClipDetector.h"
+#include "FastDecibels.h"
+#include "FixedScale.h"
+#include "LevelAverageValue.h"
+#include "LevelMeterHistory.h"
+#include "LevelMeterOverloadLog.h"
 #include "LevelPeakValue.h"
+#include "MeasurementKernel.h"
 #include "rdk/util/SubscriberList.h"
 #include <juce_audio_basics/juce_audio_basics.h>
-#include <juce_events/juce_events.h>
 #include <rdk/detail/NonCopyable.h>
 #include <readerwriterqueue/readerwriterqueue.h>
 
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+    #include <juce_dsp/juce_dsp.h>
+#endif
+
+#if JUCE_MODULE_AVAILABLE_juce_events
+    #include <juce_events/juce_events.h>
+#elif !defined(JUCE_ASSERT_MESSAGE_THREAD)
+    // Without juce_events there is no message thread, the thread which polls takes its place.
+    #define JUCE_ASSERT_MESSAGE_THREAD
+#endif
+
 /**
  * A level meter class which can be fed measurements from a realtime audio thread and be read from another (UI) thread.
+ *
+ * Level meters are refreshed by a shared juce::Timer on the juce::MessageThread, by a RefreshDriver, or by a
+ * RefreshThread. Without the juce_events module (for example in a headless process without a message loop) there is no
+ * timer, and level meters are refreshed by a RefreshThread or by calling poll() or pollAll() instead. In that case the
+ * "juce::MessageThread" in the documentation of this class means the thread which polls.
  */
 class LevelMeter : rdk::NonCopyable
 {
+    class SharedTimer;
+
 public:
+    /// The number of blocks per channel the measurement queue holds by default, which covers the interval of the
+    /// slowest refresh rate (of the background group or of idle meters) at LevelMeterConstants::kMaxBlocksPerSecond.
+    static constexpr size_t kDefaultBlocksPerRefresh = static_cast<size_t> (
+        LevelMeterConstants::kMaxBlocksPerSecond
+        / std::min (LevelMeterConstants::kBackgroundRefreshRateHz, LevelMeterConstants::kIdleRefreshRateHz));
+
     /**
      * A unit of measurement for a specific channel.
      */
@@ -22,14 +57,38 @@ public:
     {
         int channelIndex = 0;
         double peakLevel = 0.0;
+        double mean = 0.0;
+        double meanSquare = 0.0;
+        int numSamples = 0;
+        bool overloaded = false; // True when the clip detector detected clipping within the block.
+        int numNaNs = 0;
+        int numInfs = 0;
+        int numDenormals = 0;
     };
 
+    /**
+     * A run of consecutive overloaded samples on a single channel.
+     */
+    using OverloadEvent = LevelMeterOverloadLog::Event;
+    using PcmEncoding = MeasurementKernel::PcmEncoding;
+    using PcmFormat = MeasurementKernel::PcmFormat;
+
     /**
      * Class for representing ;a scale alongside a meter or slider.
+     *
+     * Mapping a linear level to a proportion uses a lookup table which is built at construction. The table is keyed by
+     * the bits of the level (which makes it logarithmic, with 2^kLookupTableBitsPerOctave cells per octave) and
+     * interpolates linearly within a cell, splitting cells at division boundaries. The error compared to the exact
+     * mapping is caused by the curvature of the logarithm within a cell and stays below 0.0011 dB, which for the
+     * default scale means a maximum error of 0.00003 in proportion. Use getLookupTableMaxError() to get the measured
+     * error of a scale. Scales with divisions closer together than a single cell use the exact mapping instead.
      */
     class Scale
     {
     public:
+        /// The number of bits of the mantissa used for the lookup table, which gives 2^n cells per octave.
+        static constexpr int kLookupTableBitsPerOctave = 5;
+
         /**
          * Constructor.
          * @param minusInfinityDb Minus infinity in decibels.
@@ -37,6 +96,25 @@ public:
          */
         Scale (double minusInfinityDb, std::initializer_list<double> divisions);
 
+        /**
+         * Constructor.
+         * @param minusInfinityDb Minus infinity in decibels.
+         * @param divisions The points (in decibels) for all divisions, starting with the lowest levels.
+         */
+        Scale (double minusInfinityDb, std::vector<double> divisions);
+
+        /**
+         * Constructs a scale with the divisions of a FixedScale, for code which takes a scale at runtime. Code which
+         * knows its scale at compile time can use the FixedScale directly, which the compiler can inline.
+         */
+        template <class Definition>
+        explicit Scale (FixedScale<Definition>) :
+            Scale (
+                Definition::kMinusInfinityDb,
+                std::vector<double> (Definition::kDivisions.begin(), Definition::kDivisions.end()))
+        {
+        }
+
         /**
          * Calculates the proportion [0.0, 1.0] for given level.
          * @param level The level [-1.0, 1.0].
@@ -44,6 +122,16 @@ public:
          */
         [[nodiscard]] double calculateProportionForLevel (double level) const;
 
+        /**
+         * Calculates the proportions [0.0, 1.0] for given levels. Works on blocks of levels, in branch free passes
+         * which compilers can vectorize, separate from the lookups in the table. Gives the same results as
+         * calculateProportionForLevel().
+         * @param levels The levels [-1.0, 1.0].
+         * @param proportions Receives the proportions, must hold numValues values. May be the same as levels.
+         * @param numValues The number of values.
+         */
+        void calculateProportionsForLevels (const double* levels, double* proportions, int numValues) const;
+
         /**
          * Calculates the proportion [0.0, 1.0] for given level.
          * @param levelDb The level in decibels [-inf, 0.0].
@@ -68,18 +156,60 @@ public:
          */
         [[nodiscard]] double getMinusInfinityDb() const;
 
+        /**
+         * @return The maximum difference in proportion between calculateProportionForLevel() and the exact mapping,
+         * as measured when building the lookup table.
+         */
+        [[nodiscard]] double getLookupTableMaxError() const;
+
         /**
          * @return Returns a default scale.
          */
         static const Scale& getDefaultScale();
 
     private:
+        /// A cell of the lookup table, which holds two linear segments split at a division boundary.
+        struct LookupCell
+        {
+            double splitLevel = 0.0;
+            double offsetBelowSplit = 0.0;
+            double slopeBelowSplit = 0.0;
+            double offsetAboveSplit = 0.0;
+            double slopeAboveSplit = 0.0;
+        };
+
         /// Used for runtime minus infinity configuration.
         // TODO: I don't think we need this, we should use the lowest value from the scale.
         double mMinusInfinityDb { LevelMeterConstants::kDefaultMinusInfinityDb };
 
         /// Stores al the levels for each division.
         std::vector<double> mDivisions;
+
+        /// The lookup table for mapping levels to proportions.
+        std::vector<LookupCell> mLookupTable;
+
+        /// The key of the first cell of the lookup table.
+        uint64_t mLookupTableFirstKey = 0;
+
+        /// Levels at or below this level map to mLowestProportion.
+        double mLowestLevel = 0.0;
+
+        /// Levels at or above this level map to mHighestProportion.
+        double mHighestLevel = 0.0;
+
+        double mLowestProportion = 0.0;
+        double mHighestProportion = 0.0;
+        double mLookupTableMaxError = 0.0;
+
+        /**
+         * Builds the lookup table from the divisions.
+         */
+        void buildLookupTable();
+
+        /**
+         * @return The lookup table key for given (positive) level.
+         */
+        static uint64_t getLookupTableKey (double level);
     };
 
     /**
@@ -90,6 +220,16 @@ public:
     public:
         static constexpr int kDefaultMaxChannels = 64;
 
+        /**
+         * Struct for holding the number of invalid samples of a channel.
+         */
+        struct InvalidSampleCounts
+        {
+            int64_t numNaNs = 0;
+            int64_t numInfs = 0;
+            int64_t numDenormals = 0;
+        };
+
         /**
          * Struct for holding measurement data per channel.
          */
@@ -98,10 +238,14 @@ public:
             LevelPeakValue<double> peakLevel;
             LevelPeakValue<double> peakHoldLevel;
             bool overloaded = false;
+            InvalidSampleCounts invalidSamples;
+            LevelAverageValue<double> dcOffset;
+            LevelAverageValue<double> meanSquare;
+            LevelPeakValue<double> crestPeakLevel;
         };
 
         Subscriber() = delete;
-        virtual ~Subscriber() = default;
+        virtual ~Subscriber();
 
         /**
          * Constructor
@@ -127,12 +271,36 @@ public:
          */
         virtual void updateWithMeasurement (const Measurement& measurement);
 
+        /**
+         * Adds all measurements which were drained in a single refresh. The default implementation calls
+         * updateWithMeasurement() for every measurement, override this to process the whole batch in one go.
+         * @param measurements The measurements, in the order in which they were measured.
+         * @param numMeasurements The number of measurements.
+         */
+        virtual void updateWithMeasurements (const Measurement* measurements, int numMeasurements);
+
         /**
          * Called when all measurements have been processed inside the timer callback.
          * Use this method to schedule any updates of UI.
          */
         virtual void measurementUpdatesFinished() {}
 
+        /**
+         * Called for every overload event, from the timer callback.
+         * @param event The overload event.
+         */
+        virtual void overloadEventOccurred ([[maybe_unused]] const OverloadEvent& event) {}
+
+        /**
+         * Called from the timer callback to find out whether this subscriber still needs updates while the signal is
+         * silent, for example because its meter is still returning. When all subscribers of a level meter have settled,
+         * the meter is skipped until the audio thread pushes a measurement which isn't silent.
+         * The default implementation checks the peak and peak hold values of all channels, override this when those
+         * are not what is shown.
+         * @return True if this subscriber has nothing left to show until the next measurement which isn't silent.
+         */
+        [[nodiscard]] virtual bool hasSettled() const;
+
         /**
          * Resets the current data to zero (or -inf) and calls measurementUpdatesFinished() to allow the subscriber to
          * update itself.
@@ -176,6 +344,25 @@ public:
          */
         double getPeakHoldValue (int channelIndex);
 
+        /**
+         * Catches up the peak and peak hold value of a channel with a level which happened some time ago, taking into
+         * account the hold time and return rate since. Use this to restore the ballistics of a subscriber which wasn't
+         * subscribed for a while.
+         * @param channelIndex The channel index.
+         * @param peakLevel The peak level.
+         * @param ageMs The time since the peak level happened, in milliseconds.
+         */
+        void catchUpPeak (int channelIndex, double peakLevel, uint32_t ageMs);
+
+        /**
+         * @param channelIndex The channel index.
+         * @param peakLevel The peak level.
+         * @param ageMs The time since the peak level happened, in milliseconds.
+         * @return The peak hold value which given peak level shows now, after the hold time and return rate of this
+         * subscriber. Use this to tell whether a lower level takes over from a peak which happened some time ago.
+         */
+        [[nodiscard]] double getCaughtUpPeakHoldValue (int channelIndex, double peakLevel, uint32_t ageMs) const;
+
         /**
          * @param channelIndex The channel index.
          * @return True if the signal was overloaded at some point in history, or false if not. Use resetOverloaded() to
@@ -188,6 +375,30 @@ public:
          */
         void resetOverloaded();
 
+        /**
+         * @param channelIndex The channel index.
+         * @return The number of NaN, infinite and denormal samples since the last reset. Use resetInvalidSamples() to
+         * reset the counts.
+         */
+        [[nodiscard]] InvalidSampleCounts getInvalidSampleCounts (int channelIndex) const;
+
+        /**
+         * @param channelIndex The channel index.
+         * @return True if NaN or infinite samples were measured since the last reset, or false if not.
+         */
+        [[nodiscard]] bool hasNonFiniteSamples (int channelIndex) const;
+
+        /**
+         * @param channelIndex The channel index.
+         * @return True if denormal samples were measured since the last reset, or false if not.
+         */
+        [[nodiscard]] bool hasDenormalSamples (int channelIndex) const;
+
+        /**
+         * Resets the counts of invalid samples.
+         */
+        void resetInvalidSamples();
+
         /**
          * @return The current scale for this subscriber.
          */
@@ -209,15 +420,182 @@ public:
          */
         void setPeakHoldTimeMs (uint32_t peakHoldTimeMs);
 
+        /**
+         * @param channelIndex The index of the channel to get the value for.
+         * @return The DC offset (the windowed mean of the signal) for given channel index.
+         */
+        double getDcOffset (int channelIndex);
+
+        /**
+         * @param channelIndex The index of the channel to get the value for.
+         * @return The crest factor (the ratio of peak to RMS level) for given channel index, or 0 if the signal is
+         * silent. Use juce::Decibels::gainToDecibels() to get the crest factor in decibels.
+         */
+        double getCrestFactor (int channelIndex);
+
+        /**
+         * Sets the integration time of the DC offset.
+         * @param integrationTimeMs The integration time in milliseconds.
+         */
+        void setDcOffsetIntegrationTimeMs (uint32_t integrationTimeMs);
+
+        /**
+         * Sets the integration time of the crest factor. This is used for both the RMS level and the hold time of the
+         * peak level of the crest factor.
+         * @param integrationTimeMs The integration time in milliseconds.
+         */
+        void setCrestFactorIntegrationTimeMs (uint32_t integrationTimeMs);
+
     private:
         const Scale& mScale;
         rdk::Subscription mSubscription;
         juce::Array<ChannelData> mChannelData;
         double mReturnRateDbPerSecond = LevelMeterConstants::kDefaultReturnRate;
+        uint32_t mDcOffsetIntegrationTimeMs = LevelMeterConstants::kDefaultDcOffsetIntegrationTimeMs;
+        uint32_t mCrestFactorIntegrationTimeMs = LevelMeterConstants::kDefaultIntegrationTimeMs;
         int mMaxChannels = kDefaultMaxChannels;
     };
 
+    /**
+     * Groups of level meters which refresh at their own rate, to spend the time of the juce::MessageThread where the
+     * user is actually looking. The refreshes of different groups are staggered, so that they don't all land on the
+     * same iteration of the message loop. All subscribers of a level meter refresh with the group of the meter.
+     */
+    enum class RefreshGroup
+    {
+        normal,     ///< Refreshes at LevelMeterConstants::kRefreshRateHz.
+        focused,    ///< Refreshes at LevelMeterConstants::kFocusedRefreshRateHz, for example for the focused strip.
+        overview,   ///< Refreshes at LevelMeterConstants::kOverviewRefreshRateHz, for example for a meter bridge.
+        background, ///< Refreshes at LevelMeterConstants::kBackgroundRefreshRateHz, for example for unfocused windows.
+    };
+
+    /// The number of refresh groups.
+    static constexpr int kNumRefreshGroups = 4;
+
+    /**
+     * @param group The refresh group.
+     * @return The refresh rate of given group.
+     */
+    static int getRefreshRateHz (RefreshGroup group);
+
+    /**
+     * Statistics about the time the shared timer (or refresh driver) spends refreshing meters.
+     */
+    struct RefreshStatistics
+    {
+        int64_t numTicks = 0;
+        int64_t numTicksOverBudget = 0;   // Ticks which ran out of budget before all due meters were refreshed.
+        int64_t numMetersCarriedOver = 0; // Refreshes of meters which were carried over to a later tick.
+        double lastTickDurationMs = 0.0;
+        double maxTickDurationMs = 0.0;
+    };
+
+    /**
+     * Sets the time the shared timer may spend refreshing meters per tick. Meters are refreshed round-robin, and the
+     * meters which were not reached when the budget ran out are refreshed on the next tick. At least one meter is
+     * refreshed every tick. Takes the processing lock, so it can be called from any thread but the audio thread.
+     * @param budgetMs The budget in milliseconds, or 0 for no budget.
+     */
+    static void setRefreshTimeBudgetMs (double budgetMs);
+
+    /**
+     * @return The time the shared timer may spend refreshing meters per tick, or 0 for no budget.
+     */
+    [[nodiscard]] static double getRefreshTimeBudgetMs();
+
+    /**
+     * @return The statistics of all refreshes since the last reset. Takes the processing lock, so the statistics can be
+     * read while a refresh thread updates them.
+     */
+    [[nodiscard]] static RefreshStatistics getRefreshStatistics();
+
+    /**
+     * Resets the statistics of all refreshes. Takes the processing lock.
+     */
+    static void resetRefreshStatistics();
+
+    /**
+     * Drives the refresh of all level meters from the outside, for example from the vertical blank of a display,
+     * instead of from the shared timer. While at least one driver exists the shared timer is stopped, and the driver
+     * which was created first refreshes the meters (so that multiple drivers don't add up). Every refresh group is
+     * still refreshed at its own rate, so the driver should be called at least as often as the fastest group needs.
+     * Ballistics are calculated from the actual time between refreshes, so meters stay correct at any refresh rate.
+     * Only use this class from the juce::MessageThread.
+     */
+    class RefreshDriver
+    {
+    public:
+        /**
+         * Constructor.
+         * @param divisor Only refresh on every divisor-th call to refresh(), for example 2 to refresh at 60 Hz on a 120
+         * Hz display.
+         */
+        explicit RefreshDriver (int divisor = 1);
+        ~RefreshDriver();
+
+        JUCE_DECLARE_NON_COPYABLE (RefreshDriver)
+        JUCE_DECLARE_NON_MOVEABLE (RefreshDriver)
+
+        /**
+         * Sets the divisor.
+         * @param divisor Only refresh on every divisor-th call to refresh().
+         */
+        void setDivisor (int divisor);
+
+        /**
+         * Refreshes all level meters, taking into account the divisor. Call this for every frame.
+         */
+        void refresh();
+
+    private:
+        juce::SharedResourcePointer<SharedTimer> mSharedTimer;
+        int mDivisor { 1 };
+        int mNumCallsSinceRefresh { 0 };
+    };
+
+    /**
+     * Refreshes all level meters from a dedicated low priority thread instead of from the juce::MessageThread, so that
+     * heavy work on the message thread doesn't delay metering and metering doesn't delay the message thread. While at
+     * least one RefreshThread exists, the shared timer and all RefreshDrivers are stopped.
+     *
+     * Refreshing means that the callbacks of all subscribers are called from the refresh thread, while holding the lock
+     * returned by getProcessingLock(). Subscribers must take the same lock when accessing their data from another
+     * thread, must not call into juce::Component from their callbacks (hand over the result instead, for example
+     * through a TripleBuffer), and must unsubscribe from the destructor of the most derived class. The subscribers in
+     * this repository do all of this.
+     * Only create and destroy this class on the juce::MessageThread.
+     */
+    class RefreshThread
+    {
+    public:
+        RefreshThread();
+        ~RefreshThread();
+
+        JUCE_DECLARE_NON_COPYABLE (RefreshThread)
+        JUCE_DECLARE_NON_MOVEABLE (RefreshThread)
+
+    private:
+        juce::SharedResourcePointer<SharedTimer> mSharedTimer;
+    };
+
+    /**
+     * @return The lock which is held while level meters are refreshed. Take this lock when accessing data of a
+     * subscriber, or the history and overload log of a level meter, from another thread than the one refreshing.
+     * The lock is uncontended unless a RefreshThread exists.
+     */
+    static juce::CriticalSection& getProcessingLock();
+
     LevelMeter();
+
+    /**
+     * Constructor.
+     * @param measurementQueueCapacity The number of measurements the queue between the audio thread and the refreshing
+     * thread can hold. Every channel of every measured block takes a measurement. Use 0 to hold
+     * kDefaultBlocksPerRefresh blocks of all channels, in which case prepareToPlay() resizes the queue when the number
+     * of channels changes.
+     */
+    explicit LevelMeter (size_t measurementQueueCapacity);
+
     ~LevelMeter();
 
     JUCE_DECLARE_NON_COPYABLE (LevelMeter)
@@ -229,6 +607,55 @@ public:
      */
     void prepareToPlay (int numChannels);
 
+    /**
+     * Prepares the meter for the amount of channels and the sample rate given. The sample rate is needed for keeping
+     * history.
+     * @param numChannels Number of channels to prepare for.
+     * @param sampleRate The sample rate of the measured audio.
+     */
+    void prepareToPlay (int numChannels, double sampleRate);
+
+    /**
+     * Sets the options for keeping level history. History is kept from the moment the meter is prepared with a sample
+     * rate. All memory needed is allocated here and in prepareToPlay().
+     * @param options The options to set. Pass options without resolutions to stop keeping history.
+     */
+    void setHistoryOptions (const LevelMeterHistory::Options& options);
+
+    /**
+     * @return The level history of this meter. Only access this from the juce::MessageThread, while holding the
+     * processing lock if a RefreshThread exists.
+     */
+    [[nodiscard]] const LevelMeterHistory& getHistory() const;
+
+    /**
+     * @return The log of overload events of this meter. Only access this from the juce::MessageThread, while holding
+     * the processing lock if a RefreshThread exists.
+     */
+    [[nodiscard]] const LevelMeterOverloadLog& getOverloadLog() const;
+
+    /**
+     * Clears the log of overload events. Only call this from the juce::MessageThread.
+     */
+    void resetOverloadLog();
+
+    /**
+     * Sets the options of the clip detector, which defines what counts as an overload. Can be called from any thread.
+     * @param options The options to set.
+     */
+    void setClipDetectorOptions (const ClipDetector::Options& options);
+
+    /**
+     * @return The current options of the clip detector.
+     */
+    [[nodiscard]] ClipDetector::Options getClipDetectorOptions() const;
+
+    /**
+     * @return The number of measurements which were dropped because the queue was full, which happens when meters
+     * aren't refreshed for longer than the queue can hold. Can be called from any thread.
+     */
+    [[nodiscard]] int64_t getNumDroppedMeasurements() const;
+
     /**
      * Measures a block of audio and sends the measurement to a queue.
      * Calling this method is realtime safe as long as being called from a single thread.
@@ -249,6 +676,91 @@ public:
     template <typename SampleType>
     void measureBlock (const SampleType* const* inputChannelData, int numChannels, int numSamples);
 
+    /**
+     * Measures a subset of channels from a range of samples in place, and sends the measurement to a queue. This allows
+     * measuring for example a single stem of a multichannel render without copying it.
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * When the queue is full the measurement will be lost.
+     * @tparam SampleType The type of the audio sample.
+     * @param inputChannelData The audio data of all source channels.
+     * @param channelMap For every channel of this meter, the index of the source channel to measure.
+     * @param numChannels The number of channels to measure, which is the number of entries in channelMap.
+     * @param startSample The index of the first sample to measure in every source channel.
+     * @param numSamples The number of samples to measure.
+     */
+    template <typename SampleType>
+    void measureBlock (
+        const SampleType* const* inputChannelData,
+        const int* channelMap,
+        int numChannels,
+        int startSample,
+        int numSamples);
+
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+    /**
+     * Measures an audio block in place and sends the measurement to a queue. Channel i of the block is measured as
+     * channel i of this meter, so sub blocks (see juce::dsp::AudioBlock::getSubBlock() and getSubsetChannelBlock())
+     * can be used to measure a range of samples or a subset of channels without copying.
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * When the queue is full the measurement will be lost.
+     * @tparam SampleType The type of the audio sample.
+     * @param block The audio block to take the measurement from.
+     */
+    template <typename SampleType>
+    void measureBlock (const juce::dsp::AudioBlock<const SampleType>& block);
+#endif
+
+    /**
+     * Measures a block of interleaved PCM audio, as it arrives from device or network I/O, and sends the measurement to
+     * a queue. The samples are measured in their own format, without a conversion buffer. Integer samples are measured
+     * with full scale at 1, and count as clipped at their largest code when the clip threshold lies above it.
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * When the queue is full the measurement will be lost.
+     * @param interleavedData The frames to take the measurement from, each holding one sample per channel.
+     * @param numChannels The number of channels per frame.
+     * @param numFrames The number of frames.
+     * @param format The format of the samples.
+     */
+    void measureInterleavedBlock (const void* interleavedData, int numChannels, int numFrames, PcmFormat format);
+
+    /**
+     * Measures a block of non-interleaved PCM audio and sends the measurement to a queue. The samples are measured in
+     * their own format, without a conversion buffer. Integer samples are measured with full scale at 1, and count as
+     * clipped at their largest code when the clip threshold lies above it.
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * When the queue is full the measurement will be lost.
+     * @param inputChannelData The samples of every channel.
+     * @param numChannels The number of channels.
+     * @param numSamples The number of samples per channel.
+     * @param format The format of the samples.
+     */
+    void measurePlanarBlock (const void* const* inputChannelData, int numChannels, int numSamples, PcmFormat format);
+
+    /**
+     * Moves this meter to given refresh group. Only call this from the juce::MessageThread.
+     * @param group The refresh group.
+     */
+    void setRefreshGroup (RefreshGroup group);
+
+    /**
+     * @return The refresh group of this meter.
+     */
+    [[nodiscard]] RefreshGroup getRefreshGroup() const;
+
+    /**
+     * Drains the pending measurements of this meter and updates its subscribers from the calling thread, regardless
+     * of its refresh group. Use this to sample the levels of a meter on demand, for example without a message loop.
+     * @return True if the subscribers were updated, or false if this meter was idle.
+     */
+    bool poll();
+
+    /**
+     * Refreshes the refresh groups which are due from the calling thread, like the shared timer would. Call this
+     * regularly (at least as often as the fastest refresh group needs) to drive all level meters without a message
+     * loop. Don't use this while a RefreshThread exists.
+     */
+    static void pollAll();
+
     /**
      * Subscribes given subscriber to this LevelMeter.
      * @param subscriber The subscriber to add.
@@ -256,61 +768,429 @@ public:
      */
     rdk::Subscription subscribe (Subscriber* subscriber);
 
+    /**
+     * Adds a child meter, whose measurements and overload events are forwarded into this meter on the consumer side
+     * when the child is refreshed. This makes this meter show the aggregate of its children without measuring the audio
+     * again, for example for a group or master meter of unsummed children.
+     *
+     * By default channels are downmixed by wrapping around: channel i of a child maps to channel (i % numChannels) of
+     * this meter. A child with the same number of channels maps one to one, a mono parent aggregates all channels, and
+     * a stereo parent aggregates the even channels of a child on the left and the odd channels on the right. Use the
+     * overload which takes a channel map for other layouts.
+     *
+     * Forwarded data goes through the same bookkeeping as measured data: overload events are added to the overload log,
+     * and measurements to the history. Every channel of a child which maps to a channel of this meter is a source of
+     * that channel. The history of a channel advances at the pace of its sources, taking the highest peak level of its
+     * sources and the average of their mean squares. Since children are refreshed one after the other, the levels of
+     * a source can land up to a refresh interval away from those of the other sources. Averaged values shown by
+     * subscribers (like the DC offset) become averages over all sources. A channel should either be measured by this
+     * meter or be fed by children, not both.
+     * A child which is destroyed before this meter removes itself from this meter, and the other way around.
+     * Only call this from the juce::MessageThread.
+     * @param child The child meter, which must not be this meter or one of its parents.
+     */
+    void addChildMeter (LevelMeter& child);
+
+    /**
+     * Adds a child meter with an explicit mapping of its channels to the channels of this meter, see addChildMeter().
+     * Only call this from the juce::MessageThread.
+     * @param child The child meter, which must not be this meter or one of its parents.
+     * @param channelMap The channel of this meter for every channel of the child, or -1 to leave a channel out.
+     * Channels beyond the end of the map, and channels mapped beyond the channels of this meter, are left out. An empty
+     * map uses the default downmix.
+     */
+    void addChildMeter (LevelMeter& child, std::vector<int> channelMap);
+
+    /**
+     * Removes a child meter which was added with addChildMeter(). Only call this from the juce::MessageThread.
+     * @param child The child meter to remove.
+     */
+    void removeChildMeter (LevelMeter& child);
+
 private:
+    class ChildLink;
+    friend class LevelMeterBank;
     /**
      * A timer which is used by all instances of LevelMeter to synchronize all repaints. This keeps the meters steady.
+     * When RefreshDrivers exist, the timer stops and the first driver refreshes the meters instead.
+     * The timer ticks at the rate of the fastest refresh group, and on every tick refreshes the groups which are due,
+     * within the time budget set with setRefreshTimeBudgetMs(). A group which could not be refreshed completely
+     * continues where it left off on the next tick.
+     * Meters which are idle are skipped, and groups in which all meters are idle back off to
+     * LevelMeterConstants::kIdleRefreshRateHz. The timer doesn't stop completely, because the audio thread can't
+     * restart it in a realtime safe way, so the slow ticks poll the pending data flag of every meter instead.
+     * When a RefreshThread exists, the same schedule runs on a worker thread instead. Every refresh runs under the
+     * processing lock, which guards all state the worker touches. The remaining state is only accessed from the
+     * juce::MessageThread.
      */
+#if JUCE_MODULE_AVAILABLE_juce_events
     class SharedTimer : private juce::Timer
+#else
+    class SharedTimer
+#endif
     {
     public:
-        SharedTimer() = default;
-        ~SharedTimer() override
+        SharedTimer()
+        {
+            for (size_t i = 0; i < mGroups.size(); ++i)
+            {
+                auto const rateHz = getRefreshRateHz (static_cast<RefreshGroup> (i));
+                mGroups[i].intervalMs = static_cast<uint32_t> (1000 / rateHz);
+
+                // Stagger the groups by a tick of the fastest group each.
+                mGroups[i].phaseMs = static_cast<uint32_t> (i * 1000 / LevelMeterConstants::kFocusedRefreshRateHz);
+            }
+        }
+
+        ~SharedTimer()
         {
+#if JUCE_MODULE_AVAILABLE_juce_events
             stopTimer(); // Paranoia.
+#endif
+
+            if (mWorker != nullptr)
+                mWorker->stopThread (kWorkerStopTimeoutMs);
         }
 
         JUCE_DECLARE_NON_COPYABLE (SharedTimer)
         JUCE_DECLARE_NON_MOVEABLE (SharedTimer)
 
         /**
-         * Subscribes given level meter to this timer.
+         * Subscribes given level meter to this timer, replacing a previous subscription.
          * @param levelMeter The level meter to subscribe.
+         * @param group The refresh group to subscribe to.
+         */
+        void subscribe (LevelMeter& levelMeter, RefreshGroup group)
+        {
+            const juce::ScopedLock lock (getProcessingLock());
+            auto& refreshGroup = mGroups[static_cast<size_t> (group)];
+
+            if (refreshGroup.levelMeters.get_num_subscribers() == 0)
+                refreshGroup.nextRefreshMs = juce::Time::getMillisecondCounter() + refreshGroup.phaseMs;
+
+            refreshGroup.isIdle = false;
+            levelMeter.mSharedTimerSubscription = refreshGroup.levelMeters.add (&levelMeter);
+            updateTimer();
+        }
+
+        /**
+         * Adds a driver, which takes over from the timer.
+         */
+        void addRefreshDriver (RefreshDriver& driver)
+        {
+            JUCE_ASSERT_MESSAGE_THREAD;
+            mRefreshDrivers.push_back (&driver);
+            updateTimer();
+        }
+
+        /**
+         * Removes a driver. The timer takes over again when the last driver is removed.
          */
-        void subscribe (LevelMeter& levelMeter)
+        void removeRefreshDriver (RefreshDriver& driver)
         {
-            // Set the timer going if we're about to subscribe the first subscriber.
-            if (mSubscribers.get_num_subscribers() == 0)
-                startTimerHz (LevelMeterConstants::kRefreshRateHz);
+            JUCE_ASSERT_MESSAGE_THREAD;
+            mRefreshDrivers.erase (
+                std::remove (mRefreshDrivers.begin(), mRefreshDrivers.end(), &driver),
+                mRefreshDrivers.end());
+            updateTimer();
+        }
 
-            levelMeter.mSharedTimerSubscription = mSubscribers.add (&levelMeter);
+        /**
+         * Refreshes the groups which are due if given driver is the one in charge.
+         */
+        void refresh (RefreshDriver& driver)
+        {
+            if (mNumRefreshThreads == 0 && !mRefreshDrivers.empty() && mRefreshDrivers.front() == &driver)
+            {
+                const juce::ScopedLock lock (getProcessingLock());
+                refreshLevelMeters();
+            }
+        }
+
+        /**
+         * Refreshes the groups which are due from the calling thread.
+         */
+        void poll()
+        {
+            jassert (mNumRefreshThreads == 0); // Polling and a refresh thread would compete for the same meters.
+
+            const juce::ScopedLock lock (getProcessingLock());
+            refreshLevelMeters();
+        }
+
+        /**
+         * Adds a refresh thread, which takes over from the timer and the drivers. Multiple refresh threads share a
+         * single worker thread.
+         */
+        void addRefreshThread()
+        {
+            if (mNumRefreshThreads++ == 0)
+            {
+                if (mWorker == nullptr)
+                    mWorker = std::make_unique<Worker> (*this);
+
+                mWorker->startThread (juce::Thread::Priority::low);
+                updateTimer();
+            }
+        }
+
+        /**
+         * Removes a refresh thread. The timer or drivers take over again when the last one is removed.
+         */
+        void removeRefreshThread()
+        {
+            jassert (mNumRefreshThreads > 0);
+
+            if (--mNumRefreshThreads == 0)
+            {
+                // Don't hold the processing lock here, the worker might be waiting for it.
+                mWorker->stopThread (kWorkerStopTimeoutMs);
+                updateTimer();
+            }
         }
 
     private:
-        rdk::SubscriberList<LevelMeter> mSubscribers;
+        /**
+         * The level meters of a refresh group, and when to refresh them.
+         */
+        struct Group
+        {
+            rdk::SubscriberList<LevelMeter> levelMeters;
+            uint32_t intervalMs = 0;
+            uint32_t phaseMs = 0;
+            uint32_t nextRefreshMs = 0;
+            bool isIdle = false;        // True if all meters were idle during the previous round.
+            size_t nextMeterIndex = 0;  // The meter to continue with, for round-robin refreshing.
+            size_t numMetersLeft = 0;   // The meters which still need refreshing in the current round.
+            bool isRoundActive = false; // True if a meter was active in the current round.
+        };
 
-        void timerCallback() override
+        /**
+         * The thread which refreshes the level meters while refresh threads exist.
+         */
+        class Worker : public juce::Thread
         {
-            // Stop timer if there are no subscribers.
-            if (mSubscribers.get_num_subscribers() == 0)
+        public:
+            explicit Worker (SharedTimer& sharedTimer) :
+                juce::Thread ("LevelMeter refresh"),
+                mSharedTimer (sharedTimer)
+            {
+            }
+
+            void run() override
+            {
+                while (!threadShouldExit())
+                    wait (mSharedTimer.refreshFromWorker());
+            }
+
+        private:
+            SharedTimer& mSharedTimer;
+        };
+
+        static constexpr int kWorkerStopTimeoutMs = 1000;
+
+        /// The refresh groups. Guarded by the processing lock, the worker refreshes them while meters subscribe.
+        std::array<Group, kNumRefreshGroups> mGroups;
+
+        /// The drivers, of which the first is in charge. Only accessed from the juce::MessageThread.
+        std::vector<RefreshDriver*> mRefreshDrivers;
+
+        /// The number of refresh threads. Atomic, because poll() checks it from any thread.
+        std::atomic<int> mNumRefreshThreads { 0 };
+
+        /// Runs the schedule while refresh threads exist. Only created and stopped from the juce::MessageThread.
+        std::unique_ptr<Worker> mWorker;
+
+        /// The rate the timer was started with. Only accessed from the juce::MessageThread.
+        int mTimerRateHz { 0 };
+
+        /// The time of the previous tick. Guarded by the processing lock.
+        uint32_t mPreviousRefreshMs { 0 };
+
+        /**
+         * @return The rate at which the groups need refreshing, or 0 if there are no level meters.
+         */
+        int getRequiredRateHz() const
+        {
+            int rateHz = 0;
+
+            for (size_t i = 0; i < mGroups.size(); ++i)
+            {
+                if (mGroups[i].levelMeters.get_num_subscribers() == 0)
+                    continue;
+
+                auto const groupRateHz = getRefreshRateHz (static_cast<RefreshGroup> (i));
+                rateHz = std::max (
+                    rateHz,
+                    mGroups[i].isIdle ? std::min (groupRateHz, LevelMeterConstants::kIdleRefreshRateHz) : groupRateHz);
+            }
+
+            return rateHz;
+        }
+
+        /**
+         * Runs the timer at the required rate when there are level meters and no drivers.
+         */
+        void updateTimer()
+        {
+            // The required rate depends on the groups, which the worker might be refreshing.
+            const juce::ScopedLock lock (getProcessingLock());
+
+            // The worker picks up the new rate on its next tick, but might be waiting for meters to appear.
+            if (mNumRefreshThreads > 0)
+                mWorker->notify();
+
+#if JUCE_MODULE_AVAILABLE_juce_events
+            auto const rateHz = getRequiredRateHz();
+
+            if (rateHz > 0 && mRefreshDrivers.empty() && mNumRefreshThreads == 0)
+            {
+                if (!isTimerRunning() || mTimerRateHz != rateHz)
+                {
+                    mTimerRateHz = rateHz;
+                    startTimerHz (rateHz);
+                }
+            }
+            else
+            {
                 stopTimer();
+            }
+#endif
+        }
+
+        /**
+         * Refreshes the level meters of every group which is due, within the time budget.
+         */
+        void refreshLevelMeters();
+
+        /**
+         * Refreshes the meters left in the current round of a group, starting from where the previous tick stopped,
+         * until the round is finished or the budget ran out.
+         * @param mustRefreshOne True to refresh at least one meter regardless of the budget, set to false once done.
+         * @return False if the budget ran out.
+         */
+        bool refreshGroup (Group& group, double deadlineMs, bool& mustRefreshOne);
+
+        /**
+         * Starts a new round for the groups which are due.
+         */
+        void startDueRounds()
+        {
+            // A group is due when it would be later than due at the next tick, which is estimated from the previous.
+            static constexpr uint32_t kMaxToleranceMs = 500 / LevelMeterConstants::kIdleRefreshRateHz;
+            auto const now = juce::Time::getMillisecondCounter();
+            auto const toleranceMs = std::min ((now - mPreviousRefreshMs) / 2, kMaxToleranceMs);
+            mPreviousRefreshMs = now;
+
+            for (auto& group : mGroups)
+            {
+                if (group.levelMeters.get_num_subscribers() == 0
+                    || static_cast<int32_t> (group.nextRefreshMs - now) > static_cast<int32_t> (toleranceMs))
+                    continue;
+
+                // A round which is still running is not restarted, so its remaining meters still get their turn.
+                if (group.numMetersLeft > 0)
+                    continue;
+
+                // Keep the phase, unless refreshes were missed.
+                group.nextRefreshMs += group.intervalMs;
+                if (static_cast<int32_t> (group.nextRefreshMs - now) <= 0)
+                    group.nextRefreshMs = now + group.intervalMs;
+
+                group.numMetersLeft = static_cast<size_t> (group.levelMeters.get_num_subscribers());
+                group.isRoundActive = false;
+            }
+        }
+
+        /**
+         * Refreshes the groups which are due from the worker thread.
+         * @return The time in milliseconds until the next tick, or -1 to wait until notified.
+         */
+        int refreshFromWorker()
+        {
+            const juce::ScopedLock lock (getProcessingLock());
+            refreshLevelMeters();
+
+            auto const rateHz = getRequiredRateHz();
+            return rateHz > 0 ? 1000 / rateHz : -1;
+        }
+
+#if JUCE_MODULE_AVAILABLE_juce_events
+        void timerCallback() override
+        {
+            const juce::ScopedLock lock (getProcessingLock());
+            refreshLevelMeters();
 
-            mSubscribers.call ([] (LevelMeter& s) {
-                s.timerCallback();
-            });
+            // Stops the timer if there are no level meters.
+            updateTimer();
         }
+#endif
     };
 
     /// Data cached from the call to prepareToPlay
     struct PreparedToPlayInfo
     {
         int numChannels = 2;
+        double sampleRate = 0.0;
     } mPreparedToPlayInfo;
 
+    /// The options for keeping history.
+    LevelMeterHistory::Options mHistoryOptions;
+
+    /// Holds the level history, which is updated from the timer callback.
+    LevelMeterHistory mHistory;
+
     /// Holds subscribers to this level meter.
     rdk::SubscriberList<Subscriber> mSubscribers;
 
+    /// True if the measurement queue is sized from the number of channels.
+    const bool mHasDefaultQueueCapacity;
+
     /// Holds the available measurements.
-    moodycamel::ReaderWriterQueue<Measurement> mMeasurements { 100 }; // Arbitrary amount.
+    moodycamel::ReaderWriterQueue<Measurement> mMeasurements;
+
+    /// The number of measurements which were dropped because the queue was full.
+    std::atomic<int64_t> mNumDroppedMeasurements { 0 };
+
+    /// The measurements drained by a refresh, kept as a member so that its storage is reused.
+    std::vector<Measurement> mDrainedMeasurements;
+
+    /// State of overload detection per channel, only accessed from the audio thread.
+    struct OverloadState
+    {
+        ClipDetector::State clipState; // Keeps runs which straddle block boundaries.
+        OverloadEvent pendingEvent;    // An event which could not be pushed because the queue was full.
+        bool hasPendingEvent = false;
+        bool isBlockOverloaded = false; // Set while the channels of an interleaved block are measured together.
+    };
+
+    /// The options of the clip detector, which are read once per block on the audio thread.
+    std::atomic<ClipDetector::Options> mClipDetectorOptions { ClipDetector::Options {} };
+
+    /// Holds the overload detection state for each channel.
+    std::vector<OverloadState> mOverloadStates;
+
+    /// The results of the channels of an interleaved block, which are measured together. Only accessed from the audio
+    /// thread, and sized like mOverloadStates.
+    std::vector<MeasurementKernel::Result> mInterleavedResults;
+
+    /// The position of the next sample to measure, only accessed from the audio thread.
+    int64_t mSamplePosition = 0;
+
+    /// Holds overload events, separate from the measurements so that they never compete for space.
+    moodycamel::ReaderWriterQueue<OverloadEvent> mOverloadEvents { 256 }; // Arbitrary amount.
+
+    /// Holds the log of overload events, which is updated from the timer callback.
+    LevelMeterOverloadLog mOverloadLog;
+
+    /// Set by the audio thread when it pushed data, cleared when the data is processed.
+    std::atomic<bool> mHasPendingData { false };
+
+    /// True if all subscribers settled during the previous refresh, which makes the meter idle until new data arrives.
+    bool mIsSettled { false };
+
+    /// The refresh group of this meter.
+    RefreshGroup mRefreshGroup { RefreshGroup::normal };
 
     /// Holds the globally shared timer.
     juce::SharedResourcePointer<SharedTimer> mSharedTimer;
@@ -318,6 +1198,25 @@ private:
     /// Holds the subscription to the shared timer.
     rdk::Subscription mSharedTimerSubscription;
 
+    /// A subscription to every child meter.
+    std::vector<std::unique_ptr<ChildLink>> mChildLinks;
+
+    /// The meters this meter is a child of, so that it can remove itself from them when destroyed.
+    std::vector<LevelMeter*> mParentMeters;
+
+    /// Measurements and overload events forwarded from child meters, waiting for the next refresh of this meter.
+    std::vector<Measurement> mChildMeasurements;
+    std::vector<OverloadEvent> mChildOverloadEvents;
+
+    /// The number of channels of child meters which map to every channel, updated when mChildSourcesChanged is set.
+    std::vector<int> mNumChildSources;
+
+    /// The samples of child meters per channel which didn't add up to a share of every source yet.
+    std::vector<int64_t> mChildSampleCounts;
+
+    /// True if the child meters or their channels changed since mNumChildSources was updated.
+    bool mChildSourcesChanged = true;
+
     /**
      * Pushes a single measurement into the queue.
      * @param measurement The measurement to push.
@@ -325,7 +1224,142 @@ private:
     void pushMeasurement (Measurement&& measurement);
 
     /**
-     * Called by the shared timer.
+     * Measures a range of channels, without advancing the sample position. Only call this from the audio thread.
+     * @param inputChannelData The audio data of the channels to measure.
+     * @param numChannels The number of channels to measure.
+     * @param numSamples The number of samples per channel.
+     * @param firstChannel The channel index of the first channel to measure.
+     */
+    template <typename SampleType>
+    void measureChannels (const SampleType* const* inputChannelData, int numChannels, int numSamples, int firstChannel);
+
+    /**
+     * Measures a single channel and pushes the measurement. Only call this from the audio thread.
+     * @param channelData The samples of the channel.
+     * @param numSamples The number of samples.
+     * @param channelIndex The channel index of this meter to publish the measurement under.
+     * @param clipDetector The clip detector with the options of the current block.
+     */
+    template <typename SampleType>
+    void measureChannel (
+        const SampleType* channelData,
+        int numSamples,
+        int channelIndex,
+        const ClipDetector& clipDetector);
+
+    /**
+     * Measures a single channel of PCM samples and pushes the measurement. Only call this from the audio thread.
+     * @param channelData The first sample of the channel.
+     * @param stride The distance in bytes between two samples of the channel.
+     * @param numSamples The number of samples.
+     * @param channelIndex The channel index of this meter to publish the measurement under.
+     * @param format The format of the samples.
+     * @param clipDetector The clip detector with the options of the current block.
+     */
+    void measurePcmChannel (
+        const void* channelData,
+        size_t stride,
+        int numSamples,
+        int channelIndex,
+        PcmFormat format,
+        const ClipDetector& clipDetector);
+
+    /**
+     * Measures the prepared channels of a block of interleaved PCM frames in a single pass, and pushes a measurement
+     * for every channel. Only call this from the audio thread.
+     * @param frames The first sample of the first frame.
+     * @param frameStride The distance in bytes between two frames.
+     * @param numChannels The number of channels to measure, at most the number of prepared channels.
+     * @param numFrames The number of frames.
+     * @param format The format of the samples.
+     * @param clipDetector The clip detector with the options of the current block.
+     */
+    void measureInterleavedChannels (
+        const uint8_t* frames,
+        size_t frameStride,
+        int numChannels,
+        int numFrames,
+        PcmFormat format,
+        const ClipDetector& clipDetector);
+
+    /**
+     * Pushes the measurement of a channel from the result of the measurement kernel.
+     */
+    void pushMeasurement (int channelIndex, int numSamples, const MeasurementKernel::Result& result, bool overloaded);
+
+    /**
+     * Runs a measurement kernel over a single channel, detects clipping on its masks and pushes the measurement.
+     * @param kernel Callable as MeasurementKernel::Result (MaskCallback& onMask), which measures the channel.
+     */
+    template <typename KernelFunction>
+    void measureChannelWith (
+        int numSamples,
+        int channelIndex,
+        const ClipDetector& clipDetector,
+        KernelFunction&& kernel);
+
+    /**
+     * Advances the sample position past a block of which all channels were measured, and flags the data as pending for
+     * the next refresh. Only call this from the audio thread.
+     * @param numSamples The number of samples per channel of the block.
+     */
+    void finishBlock (int numSamples);
+
+    /**
+     * Retries pushing overload events which didn't fit into the queue before. Only call this from the audio thread.
+     */
+    void retryPendingOverloadEvents();
+
+    /**
+     * Adds a measurement from the consumer side, which is passed to the subscribers on the next refresh. Only call this
+     * while holding the processing lock.
+     * @param measurement The measurement, with the channel index of this meter.
+     * @param addToHistory True to add the measurement to the history of this meter.
+     */
+    void forwardMeasurement (const Measurement& measurement, bool addToHistory);
+
+    /**
+     * Adds a measurement of a child meter, which is added to the history as a share of the sources of its channel and
+     * passed to the subscribers on the next refresh. Only call this while holding the processing lock.
+     * @param measurement The measurement, with a valid channel index of this meter.
+     */
+    void forwardChildMeasurement (const Measurement& measurement);
+
+    /**
+     * Removes all links to given child meter, and this meter from the parents of the child. Only call this while
+     * holding the processing lock.
+     * @param child The child meter to remove.
+     */
+    void detachChildMeter (LevelMeter& child);
+
+    /**
+     * Updates mNumChildSources if the child meters or their channels changed.
+     */
+    void updateChildSources();
+
+    /**
+     * Adds an overload event from the consumer side, which is passed to the subscribers on the next refresh. Only call
+     * this while holding the processing lock.
+     * @param event The event, with the channel index of this meter.
+     */
+    void forwardOverloadEvent (const OverloadEvent& event);
+
+    /**
+     * Pushes an overload event into the queue. If the queue is full, the event is kept and coalesced with following
+     * events until there is room again, so that no overload gets lost.
+     * @param event The event to push.
+     */
+    void pushOverloadEvent (const OverloadEvent& event);
+
+    /**
+     * Processes pending data and updates all subscribers, unless this meter is idle. The meter is idle when all
+     * subscribers have settled and there is no pending data, or only data which is silent. Called by the shared timer.
+     * @return True if the subscribers were updated, or false if this meter was idle.
+     */
+    bool refresh();
+
+    /**
+     * @return True if given measurement would change what subscribers show.
      */
-    void timerCallback();
+    static bool isActive (const Measurement& measurement);
 };
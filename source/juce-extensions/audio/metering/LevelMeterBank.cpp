@@ -0,0 +1,262 @@
+#include "LevelMeterBank.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+/**
+ * Subscription to the shared level meter, which distributes its measurements and overload events to the level meters
+ * of the bank. Channels are never folded into a single mono channel, and the channel data of the Subscriber base class
+ * is not used.
+ */
+class LevelMeterBank::Demux : public LevelMeter::Subscriber
+{
+public:
+    explicit Demux (LevelMeterBank& bank) :
+        Subscriber (LevelMeter::Scale::getDefaultScale(), std::numeric_limits<int>::max()),
+        mBank (bank)
+    {
+        subscribeToLevelMeter (bank.mTransport);
+    }
+
+    ~Demux() override
+    {
+        unsubscribeFromLevelMeter();
+    }
+
+    void updateWithMeasurement (const LevelMeter::Measurement& measurement) override
+    {
+        if (!juce::isPositiveAndBelow (measurement.channelIndex, mBank.mChannelTargets.size()))
+            return;
+
+        auto const& target = mBank.mChannelTargets[static_cast<size_t> (measurement.channelIndex)];
+        auto forwarded = measurement;
+        forwarded.channelIndex = target.channelIndex;
+        mBank.mMeters[static_cast<size_t> (target.meterIndex)]->forwardMeasurement (forwarded, true);
+    }
+
+    void updateWithMeasurements (const LevelMeter::Measurement* measurements, int const numMeasurements) override
+    {
+        for (int i = 0; i < numMeasurements; ++i)
+            Demux::updateWithMeasurement (measurements[i]);
+    }
+
+    void overloadEventOccurred (const LevelMeter::OverloadEvent& event) override
+    {
+        if (!juce::isPositiveAndBelow (event.channelIndex, mBank.mChannelTargets.size()))
+            return;
+
+        auto const& target = mBank.mChannelTargets[static_cast<size_t> (event.channelIndex)];
+        auto forwarded = event;
+        forwarded.channelIndex = target.channelIndex;
+        mBank.mMeters[static_cast<size_t> (target.meterIndex)]->forwardOverloadEvent (forwarded);
+    }
+
+    bool hasSettled() const override
+    {
+        // Nothing is shown, the level meters of the bank run their own subscribers.
+        return true;
+    }
+
+private:
+    LevelMeterBank& mBank;
+
+    void levelMeterPrepared ([[maybe_unused]] int numChannels) override {}
+};
+
+LevelMeterBank::LevelMeterBank (std::vector<int> numChannelsPerMeter, size_t const measurementQueueCapacity) :
+    mNumChannelsPerMeter (std::move (numChannelsPerMeter)),
+    mTransport (measurementQueueCapacity)
+{
+    mFirstChannels.reserve (mNumChannelsPerMeter.size());
+    mMeters.reserve (mNumChannelsPerMeter.size());
+
+    for (size_t m = 0; m < mNumChannelsPerMeter.size(); ++m)
+    {
+        jassert (mNumChannelsPerMeter[m] >= 0);
+
+        mFirstChannels.push_back (static_cast<int> (mChannelTargets.size()));
+
+        for (int ch = 0; ch < mNumChannelsPerMeter[m]; ++ch)
+            mChannelTargets.push_back ({ static_cast<int> (m), ch });
+
+        mMeters.push_back (std::make_unique<LevelMeter> (kViewQueueCapacity));
+    }
+
+    mDemux = std::make_unique<Demux> (*this);
+}
+
+LevelMeterBank::~LevelMeterBank() = default;
+
+void LevelMeterBank::prepareToPlay (double const sampleRate)
+{
+    const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+
+    mTransport.prepareToPlay (getTotalNumChannels(), sampleRate);
+
+    for (size_t m = 0; m < mMeters.size(); ++m)
+        mMeters[m]->prepareToPlay (mNumChannelsPerMeter[m], sampleRate);
+}
+
+int64_t LevelMeterBank::getNumDroppedMeasurements() const
+{
+    return mTransport.getNumDroppedMeasurements();
+}
+
+void LevelMeterBank::setClipDetectorOptions (const ClipDetector::Options& options)
+{
+    mTransport.setClipDetectorOptions (options);
+}
+
+ClipDetector::Options LevelMeterBank::getClipDetectorOptions() const
+{
+    return mTransport.getClipDetectorOptions();
+}
+
+int LevelMeterBank::getNumMeters() const
+{
+    return static_cast<int> (mMeters.size());
+}
+
+LevelMeter& LevelMeterBank::getMeter (int const meterIndex)
+{
+    jassert (juce::isPositiveAndBelow (meterIndex, mMeters.size()));
+    return *mMeters[static_cast<size_t> (meterIndex)];
+}
+
+int LevelMeterBank::getNumChannels (int const meterIndex) const
+{
+    if (juce::isPositiveAndBelow (meterIndex, mNumChannelsPerMeter.size()))
+        return mNumChannelsPerMeter[static_cast<size_t> (meterIndex)];
+    return 0;
+}
+
+int LevelMeterBank::getTotalNumChannels() const
+{
+    return static_cast<int> (mChannelTargets.size());
+}
+
+int LevelMeterBank::getFirstChannel (int const meterIndex) const
+{
+    if (juce::isPositiveAndBelow (meterIndex, mFirstChannels.size()))
+        return mFirstChannels[static_cast<size_t> (meterIndex)];
+    return getTotalNumChannels();
+}
+
+template <typename SampleType>
+void LevelMeterBank::measureBlock (const SampleType* const* inputChannelData, int numChannels, int numSamples)
+{
+    jassert (numChannels >= 0);
+    jassert (numSamples >= 0);
+
+    mTransport.retryPendingOverloadEvents();
+    mTransport.measureChannels (inputChannelData, numChannels, numSamples, 0);
+    mTransport.finishBlock (numSamples);
+}
+
+// Trigger symbol generation.
+template void LevelMeterBank::measureBlock (const float* const* inputChannelData, int numChannels, int numSamples);
+template void LevelMeterBank::measureBlock (const double* const* inputChannelData, int numChannels, int numSamples);
+
+template <typename SampleType>
+void LevelMeterBank::measureBlocks (const SampleType* const* const* meterChannelData, int numMeters, int numSamples)
+{
+    jassert (juce::isPositiveAndNotGreaterThan (numMeters, getNumMeters()));
+    jassert (numSamples >= 0);
+
+    numMeters = juce::jlimit (0, getNumMeters(), numMeters);
+
+    mTransport.retryPendingOverloadEvents();
+
+    for (int m = 0; m < numMeters; ++m)
+    {
+        mTransport.measureChannels (
+            meterChannelData[m],
+            mNumChannelsPerMeter[static_cast<size_t> (m)],
+            numSamples,
+            mFirstChannels[static_cast<size_t> (m)]);
+    }
+
+    mTransport.finishBlock (numSamples);
+}
+
+// Trigger symbol generation.
+template void LevelMeterBank::measureBlocks (const float* const* const*, int, int);
+template void LevelMeterBank::measureBlocks (const double* const* const*, int, int);
+
+template <typename SampleType>
+void LevelMeterBank::measureBlocks (const juce::AudioBuffer<SampleType>* buffers, int numMeters)
+{
+    jassert (juce::isPositiveAndNotGreaterThan (numMeters, getNumMeters()));
+
+    numMeters = juce::jlimit (0, getNumMeters(), numMeters);
+
+    if (numMeters == 0)
+        return;
+
+    auto const numSamples = buffers[0].getNumSamples();
+
+    mTransport.retryPendingOverloadEvents();
+
+    for (int m = 0; m < numMeters; ++m)
+    {
+        auto const& buffer = buffers[m];
+        jassert (buffer.getNumSamples() == numSamples);
+
+        mTransport.measureChannels (
+            buffer.getArrayOfReadPointers(),
+            std::min (buffer.getNumChannels(), mNumChannelsPerMeter[static_cast<size_t> (m)]),
+            std::min (buffer.getNumSamples(), numSamples),
+            mFirstChannels[static_cast<size_t> (m)]);
+    }
+
+    mTransport.finishBlock (numSamples);
+}
+
+// Trigger symbol generation.
+template void LevelMeterBank::measureBlocks (const juce::AudioBuffer<float>*, int);
+template void LevelMeterBank::measureBlocks (const juce::AudioBuffer<double>*, int);
+
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+template <typename SampleType>
+void LevelMeterBank::measureBlocks (const juce::dsp::AudioBlock<const SampleType>* blocks, int numMeters)
+{
+    jassert (juce::isPositiveAndNotGreaterThan (numMeters, getNumMeters()));
+
+    numMeters = juce::jlimit (0, getNumMeters(), numMeters);
+
+    if (numMeters == 0)
+        return;
+
+    auto const numSamples = static_cast<int> (blocks[0].getNumSamples());
+
+    mTransport.retryPendingOverloadEvents();
+
+    const ClipDetector clipDetector (mTransport.getClipDetectorOptions());
+
+    for (int m = 0; m < numMeters; ++m)
+    {
+        auto const& block = blocks[m];
+        jassert (static_cast<int> (block.getNumSamples()) == numSamples);
+
+        auto const numChannels =
+            std::min (static_cast<int> (block.getNumChannels()), mNumChannelsPerMeter[static_cast<size_t> (m)]);
+        auto const firstChannel = mFirstChannels[static_cast<size_t> (m)];
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            mTransport.measureChannel (
+                block.getChannelPointer (static_cast<size_t> (ch)),
+                std::min (static_cast<int> (block.getNumSamples()), numSamples),
+                firstChannel + ch,
+                clipDetector);
+        }
+    }
+
+    mTransport.finishBlock (numSamples);
+}
+
+// Trigger symbol generation.
+template void LevelMeterBank::measureBlocks (const juce::dsp::AudioBlock<const float>*, int);
+template void LevelMeterBank::measureBlocks (const juce::dsp::AudioBlock<const double>*, int);
+#endif
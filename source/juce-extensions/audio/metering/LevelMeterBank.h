@@ -0,0 +1,155 @@
+#pragma once
+
+#include "LevelMeter.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * Measures the buffers of many level meters (for example all tracks and buses of a mixer) in a single call.
+ * Measuring every meter on its own costs a queue, a pending flag and a refresh per meter for every block. A bank
+ * measures all buffers in one pass and sends the measurements of all meters through a single shared queue. On the
+ * consumer side the measurements are distributed to a LevelMeter per meter, which is a view that can be subscribed to,
+ * added to components and read like any other level meter, but which doesn't measure itself.
+ * The layout of the bank (the number of meters and the number of channels of every meter) is fixed at construction.
+ */
+class LevelMeterBank : rdk::NonCopyable
+{
+public:
+    /**
+     * Constructor.
+     * @param numChannelsPerMeter The number of channels of every meter.
+     * @param measurementQueueCapacity The number of measurements the shared queue can hold. Every channel of every
+     * measured block takes a measurement. Use 0 to hold LevelMeter::kDefaultBlocksPerRefresh blocks of all channels.
+     */
+    explicit LevelMeterBank (std::vector<int> numChannelsPerMeter, size_t measurementQueueCapacity = 0);
+
+    ~LevelMeterBank();
+
+    /**
+     * Prepares all meters. Only call this when audio processing is stopped.
+     * @param sampleRate The sample rate of the measured audio.
+     */
+    void prepareToPlay (double sampleRate);
+
+    /**
+     * @return The number of measurements which were dropped because the shared queue was full.
+     */
+    [[nodiscard]] int64_t getNumDroppedMeasurements() const;
+
+    /**
+     * Sets the options of the clip detector which measures all meters. The meters returned by getMeter() don't measure
+     * themselves, so their own clip detector options have no effect. Can be called from any thread.
+     * @param options The options to set.
+     */
+    void setClipDetectorOptions (const ClipDetector::Options& options);
+
+    /**
+     * @return The options of the clip detector which measures all meters.
+     */
+    [[nodiscard]] ClipDetector::Options getClipDetectorOptions() const;
+
+    /**
+     * @return The number of meters.
+     */
+    [[nodiscard]] int getNumMeters() const;
+
+    /**
+     * @return The level meter which shows the meter with given index.
+     */
+    [[nodiscard]] LevelMeter& getMeter (int meterIndex);
+
+    /**
+     * @return The number of channels of the meter with given index.
+     */
+    [[nodiscard]] int getNumChannels (int meterIndex) const;
+
+    /**
+     * @return The total number of channels of all meters.
+     */
+    [[nodiscard]] int getTotalNumChannels() const;
+
+    /**
+     * @return The index of the first channel of the meter with given index, when the channels of all meters are laid
+     * out one after the other.
+     */
+    [[nodiscard]] int getFirstChannel (int meterIndex) const;
+
+    /**
+     * Measures the channels of all meters, laid out one after the other, and sends the measurements to the shared
+     * queue.
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * @tparam SampleType The type of the audio sample.
+     * @param inputChannelData The audio data of all channels (see getFirstChannel()).
+     * @param numChannels The number of channels, normally getTotalNumChannels().
+     * @param numSamples The number of samples per channel.
+     */
+    template <typename SampleType>
+    void measureBlock (const SampleType* const* inputChannelData, int numChannels, int numSamples);
+
+    /**
+     * Measures a buffer for every meter and sends the measurements to the shared queue.
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * @tparam SampleType The type of the audio sample.
+     * @param meterChannelData The channel pointers of every meter, each holding getNumChannels() channels.
+     * @param numMeters The number of meters to measure, starting at the first one.
+     * @param numSamples The number of samples per channel, which is the same for all meters.
+     */
+    template <typename SampleType>
+    void measureBlocks (const SampleType* const* const* meterChannelData, int numMeters, int numSamples);
+
+    /**
+     * Measures a buffer for every meter and sends the measurements to the shared queue. Buffers with fewer channels
+     * than their meter only measure the channels they have, extra channels are ignored.
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * @tparam SampleType The type of the audio sample.
+     * @param buffers The buffer of every meter. All buffers must hold the same number of samples.
+     * @param numMeters The number of meters to measure, starting at the first one.
+     */
+    template <typename SampleType>
+    void measureBlocks (const juce::AudioBuffer<SampleType>* buffers, int numMeters);
+
+#if JUCE_MODULE_AVAILABLE_juce_dsp
+    /**
+     * Measures an audio block for every meter in place and sends the measurements to the shared queue. Blocks with
+     * fewer channels than their meter only measure the channels they have, extra channels are ignored.
+     * Calling this method is realtime safe as long as being called from a single thread.
+     * @tparam SampleType The type of the audio sample.
+     * @param blocks The audio block of every meter. All blocks must hold the same number of samples.
+     * @param numMeters The number of meters to measure, starting at the first one.
+     */
+    template <typename SampleType>
+    void measureBlocks (const juce::dsp::AudioBlock<const SampleType>* blocks, int numMeters);
+#endif
+
+private:
+    class Demux;
+
+    /// The channel which a channel of the shared queue is distributed to.
+    struct ChannelTarget
+    {
+        int meterIndex = 0;
+        int channelIndex = 0;
+    };
+
+    /// The queue capacity of the level meters in mMeters, whose queues stay empty since they don't measure.
+    static constexpr size_t kViewQueueCapacity = 1;
+
+    /// The number of channels of every meter.
+    const std::vector<int> mNumChannelsPerMeter;
+
+    /// The index of the first channel of every meter.
+    std::vector<int> mFirstChannels;
+
+    /// The meter and channel of every channel of the shared queue.
+    std::vector<ChannelTarget> mChannelTargets;
+
+    /// Measures all channels and holds the shared queue. Created before the views, so it's refreshed before them.
+    LevelMeter mTransport;
+
+    /// The level meter of every meter, which receives its measurements from mTransport.
+    std::vector<std::unique_ptr<LevelMeter>> mMeters;
+
+    /// Distributes the measurements of mTransport to mMeters.
+    std::unique_ptr<Demux> mDemux;
+};
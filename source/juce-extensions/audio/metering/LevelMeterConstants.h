@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 class LevelMeterConstants
 {
 public:
@@ -12,9 +14,34 @@ public:
     /// The refresh rate of the meter.
     static constexpr int kRefreshRateHz = 30;
 
+    /// The refresh rate of meters in the focused refresh group.
+    static constexpr int kFocusedRefreshRateHz = 60;
+
+    /// The refresh rate of meters in the overview refresh group.
+    static constexpr int kOverviewRefreshRateHz = 20;
+
+    /// The refresh rate of meters in the background refresh group.
+    static constexpr int kBackgroundRefreshRateHz = 5;
+
+    /// The refresh rate of the shared timer while all meters are idle, which is how often it polls for new data.
+    static constexpr int kIdleRefreshRateHz = 10;
+
+    /// The highest rate of blocks per channel which the default measurement queues can hold between two refreshes,
+    /// 48 kHz in blocks of 32 samples.
+    static constexpr int kMaxBlocksPerSecond = 48000 / 32;
+
+    /// The default time in milliseconds the shared timer may spend refreshing meters per tick.
+    static constexpr double kDefaultRefreshTimeBudgetMs = 4.0;
+
     /// The amount of time in milliseconds the peak hold has to wait before declining.
     static constexpr uint32_t kPeakHoldDefaultValueTimeMs = 2000;
 
+    /// The default integration time in milliseconds for averaged values, like the RMS level used for crest factor.
+    static constexpr uint32_t kDefaultIntegrationTimeMs = 300;
+
+    /// The default integration time in milliseconds for the DC offset.
+    static constexpr uint32_t kDefaultDcOffsetIntegrationTimeMs = 1000;
+
     /// The level which triggers the overload indication
     static constexpr float kOverloadTriggerLevel = 1.001f;
 };
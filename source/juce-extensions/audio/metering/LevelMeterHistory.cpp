@@ -0,0 +1,344 @@
+#include "LevelMeterHistory.h"
+
+namespace
+{
+
+/**
+ * Adds a part (a block of audio, or a frame of a finer resolution) to an accumulator.
+ */
+template <typename Accumulator>
+void accumulate (Accumulator& acc, float minLevel, float maxLevel, double sumSquares, int64_t numSamples)
+{
+    if (acc.numParts == 0)
+    {
+        acc.minLevel = minLevel;
+        acc.maxLevel = maxLevel;
+    }
+    else
+    {
+        acc.minLevel = juce::jmin (acc.minLevel, minLevel);
+        acc.maxLevel = juce::jmax (acc.maxLevel, maxLevel);
+    }
+
+    acc.sumSquares += sumSquares;
+    acc.numSamples += numSamples;
+    acc.numParts++;
+}
+
+/**
+ * @return The RMS level of the parts added to an accumulator.
+ */
+template <typename Accumulator>
+float getRmsLevel (const Accumulator& acc)
+{
+    return static_cast<float> (std::sqrt (acc.sumSquares / static_cast<double> (acc.numSamples)));
+}
+
+} // namespace
+
+LevelMeterHistory::Options LevelMeterHistory::Options::getDefault()
+{
+    return { {
+        { 10.0, 1000 },    // 10 seconds of 10ms frames.
+        { 1000.0, 3600 },  // 1 hour of 1s frames.
+        { 60000.0, 1440 }, // 24 hours of 1min frames.
+    } };
+}
+
+void LevelMeterHistory::prepare (int const numChannels, double const sampleRate, const Options& options)
+{
+    jassert (numChannels >= 0);
+
+    mResolutions.clear();
+    mRings.clear();
+    mNumChannels = 0;
+
+    if (numChannels <= 0 || sampleRate <= 0.0 || options.resolutions.empty())
+        return;
+
+    double previousDurationMs = 0.0;
+    double previousDurationSeconds = 0.0;
+
+    for (auto& resolution : options.resolutions)
+    {
+        ResolutionInfo info;
+        info.numFrames = juce::jmax (1, resolution.numFrames);
+        info.treeSize = juce::nextPowerOfTwo (info.numFrames);
+
+        if (mResolutions.empty())
+        {
+            auto const partsPerFrame = std::llround (resolution.frameDurationMs * sampleRate / 1000.0);
+            info.partsPerFrame = juce::jmax (int64_t (1), static_cast<int64_t> (partsPerFrame));
+            info.frameDurationSeconds = static_cast<double> (info.partsPerFrame) / sampleRate;
+        }
+        else
+        {
+            // The duration of a frame should be a multiple of the duration of the previous resolution.
+            jassert (resolution.frameDurationMs >= previousDurationMs);
+            auto const partsPerFrame = std::llround (resolution.frameDurationMs / previousDurationMs);
+            info.partsPerFrame = juce::jmax (int64_t (1), static_cast<int64_t> (partsPerFrame));
+            info.frameDurationSeconds = static_cast<double> (info.partsPerFrame) * previousDurationSeconds;
+        }
+
+        previousDurationMs = resolution.frameDurationMs;
+        previousDurationSeconds = info.frameDurationSeconds;
+        mResolutions.push_back (info);
+    }
+
+    mNumChannels = numChannels;
+    mRings.resize (static_cast<size_t> (numChannels) * mResolutions.size());
+
+    for (size_t i = 0; i < mRings.size(); ++i)
+    {
+        auto& info = mResolutions[i % mResolutions.size()];
+        mRings[i].frames.resize (static_cast<size_t> (info.numFrames));
+        mRings[i].maxTree.resize (static_cast<size_t> (info.treeSize) * 2);
+    }
+}
+
+void LevelMeterHistory::reset()
+{
+    for (auto& ring : mRings)
+    {
+        std::fill (ring.frames.begin(), ring.frames.end(), Frame {});
+        std::fill (ring.maxTree.begin(), ring.maxTree.end(), 0.f);
+        ring.numFramesWritten = 0;
+        ring.accumulator = {};
+    }
+}
+
+bool LevelMeterHistory::isEnabled() const
+{
+    return !mRings.empty();
+}
+
+void LevelMeterHistory::addBlock (int const channelIndex, double peakLevel, double meanSquare, int numSamples)
+{
+    if (!isEnabled() || !juce::isPositiveAndBelow (channelIndex, mNumChannels) || numSamples <= 0)
+        return;
+
+    auto& acc = getRing (channelIndex, 0).accumulator;
+    auto const samplesPerFrame = mResolutions.front().partsPerFrame;
+    auto const peak = static_cast<float> (peakLevel);
+
+    // Split the block over frame boundaries to keep the time axis sample accurate.
+    auto remaining = static_cast<int64_t> (numSamples);
+    while (remaining > 0)
+    {
+        auto const n = juce::jmin (remaining, samplesPerFrame - acc.numSamples);
+        accumulate (acc, peak, peak, meanSquare * static_cast<double> (n), n);
+        remaining -= n;
+
+        if (acc.numSamples >= samplesPerFrame)
+        {
+            auto const completed = std::exchange (acc, {});
+            addFrame (channelIndex,
+                      0,
+                      { completed.minLevel, completed.maxLevel, getRmsLevel (completed) },
+                      completed.sumSquares,
+                      completed.numSamples);
+        }
+    }
+}
+
+int LevelMeterHistory::getNumChannels() const
+{
+    return mNumChannels;
+}
+
+int LevelMeterHistory::getNumResolutions() const
+{
+    return static_cast<int> (mResolutions.size());
+}
+
+double LevelMeterHistory::getFrameDurationSeconds (int const resolutionIndex) const
+{
+    if (juce::isPositiveAndBelow (resolutionIndex, mResolutions.size()))
+        return mResolutions[static_cast<size_t> (resolutionIndex)].frameDurationSeconds;
+    return 0.0;
+}
+
+int LevelMeterHistory::getNumFrames (int const resolutionIndex) const
+{
+    if (juce::isPositiveAndBelow (resolutionIndex, mResolutions.size()))
+        return mResolutions[static_cast<size_t> (resolutionIndex)].numFrames;
+    return 0;
+}
+
+int64_t LevelMeterHistory::getNumFramesWritten (int const channelIndex, int const resolutionIndex) const
+{
+    if (!juce::isPositiveAndBelow (channelIndex, mNumChannels) ||
+        !juce::isPositiveAndBelow (resolutionIndex, mResolutions.size()))
+        return 0;
+
+    return getRing (channelIndex, resolutionIndex).numFramesWritten;
+}
+
+LevelMeterHistory::Frame
+LevelMeterHistory::getFrame (int const channelIndex, int const resolutionIndex, int64_t const frameIndex) const
+{
+    if (!juce::isPositiveAndBelow (channelIndex, mNumChannels) ||
+        !juce::isPositiveAndBelow (resolutionIndex, mResolutions.size()))
+        return {};
+
+    auto& ring = getRing (channelIndex, resolutionIndex);
+    auto const numFrames = static_cast<int64_t> (ring.frames.size());
+
+    if (frameIndex < 0 || frameIndex >= ring.numFramesWritten || frameIndex < ring.numFramesWritten - numFrames)
+        return {};
+
+    return ring.frames[static_cast<size_t> (frameIndex % numFrames)];
+}
+
+float LevelMeterHistory::getMaxLevel (
+    int const channelIndex,
+    int const resolutionIndex,
+    int64_t startFrame,
+    int64_t endFrame) const
+{
+    if (!juce::isPositiveAndBelow (channelIndex, mNumChannels) ||
+        !juce::isPositiveAndBelow (resolutionIndex, mResolutions.size()))
+        return 0.f;
+
+    auto& info = mResolutions[static_cast<size_t> (resolutionIndex)];
+    auto& ring = getRing (channelIndex, resolutionIndex);
+    auto const numFrames = static_cast<int64_t> (info.numFrames);
+
+    startFrame = juce::jmax (startFrame, ring.numFramesWritten - numFrames, int64_t (0));
+    endFrame = juce::jmin (endFrame, ring.numFramesWritten);
+
+    if (startFrame >= endFrame)
+        return 0.f;
+
+    auto const startSlot = static_cast<int> (startFrame % numFrames);
+    auto const length = static_cast<int> (endFrame - startFrame);
+
+    if (startSlot + length <= info.numFrames)
+        return queryMaxTree (ring, info.treeSize, startSlot, startSlot + length);
+
+    // The range wraps around the end of the ring.
+    return juce::jmax (queryMaxTree (ring, info.treeSize, startSlot, info.numFrames),
+                       queryMaxTree (ring, info.treeSize, 0, startSlot + length - info.numFrames));
+}
+
+float LevelMeterHistory::getMaxLevel (int const channelIndex, double startSecondsAgo, double endSecondsAgo) const
+{
+    jassert (startSecondsAgo >= endSecondsAgo);
+
+    if (!isEnabled())
+        return 0.f;
+
+    auto const resolutionIndex = findResolutionForSecondsAgo (startSecondsAgo);
+    auto const frameDuration = getFrameDurationSeconds (resolutionIndex);
+    auto const numFramesWritten = getNumFramesWritten (channelIndex, resolutionIndex);
+
+    auto const startFrame = numFramesWritten - static_cast<int64_t> (std::ceil (startSecondsAgo / frameDuration));
+    auto endFrame = numFramesWritten - static_cast<int64_t> (std::floor (endSecondsAgo / frameDuration));
+
+    if (endFrame <= startFrame)
+        endFrame = startFrame + 1; // The range is smaller than a frame.
+
+    return getMaxLevel (channelIndex, resolutionIndex, startFrame, endFrame);
+}
+
+LevelMeterHistory::Frame LevelMeterHistory::getFrameAt (int const channelIndex, double const secondsAgo) const
+{
+    if (!isEnabled())
+        return {};
+
+    auto const resolutionIndex = findResolutionForSecondsAgo (secondsAgo);
+    auto const frameDuration = getFrameDurationSeconds (resolutionIndex);
+    auto const numFramesWritten = getNumFramesWritten (channelIndex, resolutionIndex);
+
+    return getFrame (
+        channelIndex,
+        resolutionIndex,
+        numFramesWritten - 1 - static_cast<int64_t> (std::floor (secondsAgo / frameDuration)));
+}
+
+int LevelMeterHistory::findResolutionForSecondsAgo (double const secondsAgo) const
+{
+    for (size_t i = 0; i < mResolutions.size(); ++i)
+    {
+        auto& info = mResolutions[i];
+        if (static_cast<double> (info.numFrames) * info.frameDurationSeconds >= secondsAgo)
+            return static_cast<int> (i);
+    }
+
+    return getNumResolutions() - 1;
+}
+
+LevelMeterHistory::Ring& LevelMeterHistory::getRing (int const channelIndex, int const resolutionIndex)
+{
+    return mRings[static_cast<size_t> (channelIndex) * mResolutions.size() + static_cast<size_t> (resolutionIndex)];
+}
+
+const LevelMeterHistory::Ring& LevelMeterHistory::getRing (int const channelIndex, int const resolutionIndex) const
+{
+    return mRings[static_cast<size_t> (channelIndex) * mResolutions.size() + static_cast<size_t> (resolutionIndex)];
+}
+
+void LevelMeterHistory::addFrame (
+    int const channelIndex,
+    int const resolutionIndex,
+    const Frame& frame,
+    double const sumSquares,
+    int64_t const numSamples)
+{
+    writeFrame (channelIndex, resolutionIndex, frame);
+
+    // Cascade into the next (coarser) resolution.
+    auto const nextResolutionIndex = resolutionIndex + 1;
+    if (nextResolutionIndex >= getNumResolutions())
+        return;
+
+    auto& acc = getRing (channelIndex, nextResolutionIndex).accumulator;
+    accumulate (acc, frame.minLevel, frame.maxLevel, sumSquares, numSamples);
+
+    if (acc.numParts >= mResolutions[static_cast<size_t> (nextResolutionIndex)].partsPerFrame)
+    {
+        auto const completed = std::exchange (acc, {});
+        addFrame (channelIndex,
+                  nextResolutionIndex,
+                  { completed.minLevel, completed.maxLevel, getRmsLevel (completed) },
+                  completed.sumSquares,
+                  completed.numSamples);
+    }
+}
+
+void LevelMeterHistory::writeFrame (int const channelIndex, int const resolutionIndex, const Frame& frame)
+{
+    auto& info = mResolutions[static_cast<size_t> (resolutionIndex)];
+    auto& ring = getRing (channelIndex, resolutionIndex);
+
+    auto const slot = static_cast<int> (ring.numFramesWritten % info.numFrames);
+    ring.frames[static_cast<size_t> (slot)] = frame;
+    ring.numFramesWritten++;
+
+    // Update the segment tree from the leaf up to the root.
+    auto node = static_cast<size_t> (info.treeSize + slot);
+    ring.maxTree[node] = frame.maxLevel;
+
+    for (node /= 2; node >= 1; node /= 2)
+        ring.maxTree[node] = juce::jmax (ring.maxTree[node * 2], ring.maxTree[node * 2 + 1]);
+}
+
+float LevelMeterHistory::queryMaxTree (const Ring& ring, int const treeSize, int startSlot, int endSlot) const
+{
+    auto result = 0.f;
+
+    auto l = static_cast<size_t> (startSlot + treeSize);
+    auto r = static_cast<size_t> (endSlot + treeSize);
+
+    while (l < r)
+    {
+        if (l & 1)
+            result = juce::jmax (result, ring.maxTree[l++]);
+        if (r & 1)
+            result = juce::jmax (result, ring.maxTree[--r]);
+        l /= 2;
+        r /= 2;
+    }
+
+    return result;
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Keeps the level history of a meter in cascaded ring buffers of decreasing resolution (for example 10ms, 1s and 1min
+ * frames). Every frame stores the min, max and RMS level of the period it represents, and every ring buffer keeps a
+ * segment tree of its max values so that the max over any range of frames can be queried in O(log n).
+ * All memory is allocated in prepare(), adding blocks is allocation free.
+ */
+class LevelMeterHistory
+{
+public:
+    /**
+     * The levels of a single frame of history.
+     */
+    struct Frame
+    {
+        /// The lowest block peak level within the frame.
+        float minLevel = 0.f;
+
+        /// The highest block peak level within the frame.
+        float maxLevel = 0.f;
+
+        /// The RMS level over all samples within the frame.
+        float rmsLevel = 0.f;
+    };
+
+    /**
+     * Describes a single ring buffer of history.
+     */
+    struct Resolution
+    {
+        /// The duration of a single frame in milliseconds. Must be a multiple of the duration of the previous
+        /// resolution.
+        double frameDurationMs = 10.0;
+
+        /// The number of frames to keep.
+        int numFrames = 0;
+    };
+
+    /**
+     * Options to configure the history.
+     */
+    struct Options
+    {
+        /// The resolutions to keep history for, ordered from fine to coarse. When empty, no history will be kept.
+        std::vector<Resolution> resolutions;
+
+        /**
+         * @return Options for 10 seconds of 10ms frames, 1 hour of 1s frames and 24 hours of 1min frames.
+         */
+        static Options getDefault();
+    };
+
+    LevelMeterHistory() = default;
+
+    /**
+     * Prepares the history, allocating all the memory needed.
+     * @param numChannels The number of channels to keep history for.
+     * @param sampleRate The sample rate of the measured audio.
+     * @param options The options to configure the history with.
+     */
+    void prepare (int numChannels, double sampleRate, const Options& options);
+
+    /**
+     * Clears all history, keeping the current configuration.
+     */
+    void reset();
+
+    /**
+     * @return True if history is being kept, or false if not.
+     */
+    [[nodiscard]] bool isEnabled() const;
+
+    /**
+     * Adds the measurement of a block of audio to the history.
+     * @param channelIndex The index of the channel.
+     * @param peakLevel The peak level of the block.
+     * @param meanSquare The mean of the squared samples of the block.
+     * @param numSamples The number of samples in the block.
+     */
+    void addBlock (int channelIndex, double peakLevel, double meanSquare, int numSamples);
+
+    /**
+     * @return The number of prepared channels.
+     */
+    [[nodiscard]] int getNumChannels() const;
+
+    /**
+     * @return The number of resolutions.
+     */
+    [[nodiscard]] int getNumResolutions() const;
+
+    /**
+     * @param resolutionIndex The index of the resolution.
+     * @return The duration of a single frame of given resolution, in seconds.
+     */
+    [[nodiscard]] double getFrameDurationSeconds (int resolutionIndex) const;
+
+    /**
+     * @param resolutionIndex The index of the resolution.
+     * @return The number of frames which are kept for given resolution.
+     */
+    [[nodiscard]] int getNumFrames (int resolutionIndex) const;
+
+    /**
+     * @param channelIndex The index of the channel.
+     * @param resolutionIndex The index of the resolution.
+     * @return The total number of frames written since prepare() or reset(). The newest frame has index
+     * getNumFramesWritten() - 1.
+     */
+    [[nodiscard]] int64_t getNumFramesWritten (int channelIndex, int resolutionIndex) const;
+
+    /**
+     * @param channelIndex The index of the channel.
+     * @param resolutionIndex The index of the resolution.
+     * @param frameIndex The index of the frame, see getNumFramesWritten().
+     * @return The frame, or an empty frame if the frame is not (or no longer) available.
+     */
+    [[nodiscard]] Frame getFrame (int channelIndex, int resolutionIndex, int64_t frameIndex) const;
+
+    /**
+     * Finds the max level over a range of frames in O(log n).
+     * @param channelIndex The index of the channel.
+     * @param resolutionIndex The index of the resolution.
+     * @param startFrame The first frame of the range.
+     * @param endFrame The end of the range (exclusive).
+     * @return The max level over given range, or 0 if none of the frames are available.
+     */
+    [[nodiscard]] float getMaxLevel (int channelIndex, int resolutionIndex, int64_t startFrame, int64_t endFrame) const;
+
+    /**
+     * Finds the max level over a range of time, using the finest resolution which still covers the range.
+     * @param channelIndex The index of the channel.
+     * @param startSecondsAgo The start of the range, in seconds before now.
+     * @param endSecondsAgo The end of the range, in seconds before now. Must be smaller than startSecondsAgo.
+     * @return The max level over given range.
+     */
+    [[nodiscard]] float getMaxLevel (int channelIndex, double startSecondsAgo, double endSecondsAgo) const;
+
+    /**
+     * Finds the frame at given point in time, using the finest resolution which still covers it.
+     * @param channelIndex The index of the channel.
+     * @param secondsAgo The point in time, in seconds before now.
+     * @return The frame at given point in time.
+     */
+    [[nodiscard]] Frame getFrameAt (int channelIndex, double secondsAgo) const;
+
+    /**
+     * @param secondsAgo The point in time, in seconds before now.
+     * @return The index of the finest resolution which still holds frames for given point in time, or the coarsest
+     * resolution if none do.
+     */
+    [[nodiscard]] int findResolutionForSecondsAgo (double secondsAgo) const;
+
+private:
+    /// Accumulates blocks (or frames of a finer resolution) into a frame.
+    struct Accumulator
+    {
+        float minLevel = 0.f;
+        float maxLevel = 0.f;
+        double sumSquares = 0.0;
+        int64_t numSamples = 0;
+        int64_t numParts = 0;
+    };
+
+    /// A single ring buffer of frames.
+    struct Ring
+    {
+        std::vector<Frame> frames;
+        std::vector<float> maxTree;
+        int64_t numFramesWritten = 0;
+        Accumulator accumulator;
+    };
+
+    /// The configuration per resolution, shared by all channels.
+    struct ResolutionInfo
+    {
+        double frameDurationSeconds = 0.0;
+        int numFrames = 0;
+        int treeSize = 0;
+        int64_t partsPerFrame = 1; // Samples per frame for the first resolution, finer frames for the others.
+    };
+
+    std::vector<ResolutionInfo> mResolutions;
+    std::vector<Ring> mRings; // Indexed by channelIndex * numResolutions + resolutionIndex.
+    int mNumChannels = 0;
+
+    Ring& getRing (int channelIndex, int resolutionIndex);
+    [[nodiscard]] const Ring& getRing (int channelIndex, int resolutionIndex) const;
+
+    void addFrame (int channelIndex, int resolutionIndex, const Frame& frame, double sumSquares, int64_t numSamples);
+    void writeFrame (int channelIndex, int resolutionIndex, const Frame& frame);
+    [[nodiscard]] float queryMaxTree (const Ring& ring, int treeSize, int startSlot, int endSlot) const;
+};
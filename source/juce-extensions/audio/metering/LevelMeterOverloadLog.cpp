@@ -0,0 +1,74 @@
+#include "LevelMeterOverloadLog.h"
+
+void LevelMeterOverloadLog::prepare (int const numChannels, int const maxEventsPerChannel)
+{
+    jassert (numChannels >= 0);
+    jassert (maxEventsPerChannel > 0);
+
+    mChannels.clear();
+    mChannels.resize (static_cast<size_t> (juce::jmax (0, numChannels)));
+
+    for (auto& channel : mChannels)
+        channel.recentEvents.resize (static_cast<size_t> (juce::jmax (1, maxEventsPerChannel)));
+}
+
+void LevelMeterOverloadLog::reset()
+{
+    for (auto& channel : mChannels)
+    {
+        std::fill (channel.recentEvents.begin(), channel.recentEvents.end(), Event {});
+        channel.numEventsAdded = 0;
+        channel.numRuns = 0;
+        channel.numOverloadedSamples = 0;
+    }
+}
+
+void LevelMeterOverloadLog::addEvent (const Event& event)
+{
+    if (!juce::isPositiveAndBelow (event.channelIndex, mChannels.size()))
+    {
+        jassertfalse; // Channel index out of range, was the log prepared with the correct number of channels?
+        return;
+    }
+
+    auto& channel = mChannels[static_cast<size_t> (event.channelIndex)];
+    auto const capacity = static_cast<int64_t> (channel.recentEvents.size());
+
+    channel.recentEvents[static_cast<size_t> (channel.numEventsAdded % capacity)] = event;
+    channel.numEventsAdded++;
+    channel.numRuns += event.numRuns;
+    channel.numOverloadedSamples += event.runLength;
+}
+
+int64_t LevelMeterOverloadLog::getNumEvents (int const channelIndex) const
+{
+    if (juce::isPositiveAndBelow (channelIndex, mChannels.size()))
+        return mChannels[static_cast<size_t> (channelIndex)].numRuns;
+    return 0;
+}
+
+int64_t LevelMeterOverloadLog::getNumOverloadedSamples (int const channelIndex) const
+{
+    if (juce::isPositiveAndBelow (channelIndex, mChannels.size()))
+        return mChannels[static_cast<size_t> (channelIndex)].numOverloadedSamples;
+    return 0;
+}
+
+int LevelMeterOverloadLog::getNumRecentEvents (int const channelIndex) const
+{
+    if (!juce::isPositiveAndBelow (channelIndex, mChannels.size()))
+        return 0;
+
+    auto& channel = mChannels[static_cast<size_t> (channelIndex)];
+    return static_cast<int> (juce::jmin (channel.numEventsAdded, static_cast<int64_t> (channel.recentEvents.size())));
+}
+
+LevelMeterOverloadLog::Event LevelMeterOverloadLog::getRecentEvent (int const channelIndex, int const index) const
+{
+    if (!juce::isPositiveAndBelow (index, getNumRecentEvents (channelIndex)))
+        return {};
+
+    auto& channel = mChannels[static_cast<size_t> (channelIndex)];
+    auto const capacity = static_cast<int64_t> (channel.recentEvents.size());
+    return channel.recentEvents[static_cast<size_t> ((channel.numEventsAdded - 1 - index) % capacity)];
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <juce_core/juce_core.h>
+
+/**
+ * Keeps track of the overload events of a level meter: the number of events per channel and the most recent events per
+ * channel. All memory is allocated in prepare().
+ */
+class LevelMeterOverloadLog
+{
+public:
+    /// The default number of recent events to keep per channel.
+    static constexpr int kDefaultMaxEventsPerChannel = 64;
+
+    /**
+     * A run of consecutive overloaded samples on a single channel.
+     */
+    struct Event
+    {
+        /// The index of the channel.
+        int channelIndex = 0;
+
+        /// The position of the first overloaded sample, counted from the moment the level meter was prepared.
+        int64_t samplePosition = 0;
+
+        /// The number of consecutive overloaded samples.
+        int64_t runLength = 0;
+
+        /// The highest absolute sample value within the run.
+        float peakLevel = 0.f;
+
+        /// The number of runs this event represents. This is more than 1 when events had to be coalesced because the
+        /// event queue was full, in which case the position is that of the first run and the run length is the total of
+        /// all runs.
+        int numRuns = 1;
+    };
+
+    LevelMeterOverloadLog() = default;
+
+    /**
+     * Prepares the log, allocating all the memory needed and clearing all events.
+     * @param numChannels The number of channels to keep events for.
+     * @param maxEventsPerChannel The number of recent events to keep per channel.
+     */
+    void prepare (int numChannels, int maxEventsPerChannel = kDefaultMaxEventsPerChannel);
+
+    /**
+     * Clears all events, keeping the current configuration.
+     */
+    void reset();
+
+    /**
+     * Adds an event to the log.
+     * @param event The event to add.
+     */
+    void addEvent (const Event& event);
+
+    /**
+     * @param channelIndex The index of the channel.
+     * @return The total number of overload runs on given channel since the log was prepared or reset.
+     */
+    [[nodiscard]] int64_t getNumEvents (int channelIndex) const;
+
+    /**
+     * @param channelIndex The index of the channel.
+     * @return The total number of overloaded samples on given channel since the log was prepared or reset.
+     */
+    [[nodiscard]] int64_t getNumOverloadedSamples (int channelIndex) const;
+
+    /**
+     * @param channelIndex The index of the channel.
+     * @return The number of recent events which are available for given channel.
+     */
+    [[nodiscard]] int getNumRecentEvents (int channelIndex) const;
+
+    /**
+     * @param channelIndex The index of the channel.
+     * @param index The index of the event, where 0 is the most recent event.
+     * @return The event, or an empty event if the index is out of range.
+     */
+    [[nodiscard]] Event getRecentEvent (int channelIndex, int index) const;
+
+private:
+    struct ChannelLog
+    {
+        std::vector<Event> recentEvents; // Ring buffer.
+        int64_t numEventsAdded = 0;      // Number of entries added to the ring buffer.
+        int64_t numRuns = 0;
+        int64_t numOverloadedSamples = 0;
+    };
+
+    std::vector<ChannelLog> mChannels;
+};
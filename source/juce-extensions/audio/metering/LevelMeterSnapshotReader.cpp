@@ -0,0 +1,56 @@
+#include "LevelMeterSnapshotReader.h"
+
+LevelMeterSnapshotReader::LevelMeterSnapshotReader (
+    LevelMeter& levelMeter,
+    const LevelMeter::Scale& scale,
+    int const maxChannels) :
+    Subscriber (scale, maxChannels)
+{
+    subscribeToLevelMeter (levelMeter);
+}
+
+LevelMeterSnapshotReader::~LevelMeterSnapshotReader()
+{
+    unsubscribeFromLevelMeter();
+}
+
+const LevelMeterSnapshotReader::Snapshot& LevelMeterSnapshotReader::read()
+{
+    mSnapshots.update();
+    return mSnapshots.getReadBuffer();
+}
+
+void LevelMeterSnapshotReader::resetOverloaded()
+{
+    // The overloaded flags are updated by the thread which refreshes the level meter.
+    const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+    Subscriber::resetOverloaded();
+}
+
+void LevelMeterSnapshotReader::measurementUpdatesFinished()
+{
+    auto const numChannels = getNumChannels();
+
+    auto& snapshot = mSnapshots.getWriteBuffer();
+    snapshot.sequenceNumber = mNextSequenceNumber++;
+    snapshot.timeMs = juce::Time::getMillisecondCounter();
+    snapshot.channels.resize (static_cast<size_t> (numChannels));
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& channel = snapshot.channels[static_cast<size_t> (ch)];
+        channel.peakLevel = getPeakValue (ch);
+        channel.peakHoldLevel = getPeakHoldValue (ch);
+        channel.overloaded = isOverloaded (ch);
+        channel.dcOffset = getDcOffset (ch);
+        channel.crestFactor = getCrestFactor (ch);
+        channel.invalidSamples = getInvalidSampleCounts (ch);
+    }
+
+    mSnapshots.publish();
+}
+
+void LevelMeterSnapshotReader::levelMeterPrepared ([[maybe_unused]] int numChannels)
+{
+    // The next refresh publishes a snapshot with the new number of channels.
+}
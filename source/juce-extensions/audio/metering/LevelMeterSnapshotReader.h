@@ -0,0 +1,92 @@
+#pragma once
+
+#include "LevelMeter.h"
+#include "TripleBuffer.h"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Publishes the state of all channels of a level meter as an immutable snapshot after every refresh, so that any
+ * thread (for example an OpenGL renderer, a control surface driver or an OSC sender) can read the latest state without
+ * locking and without waiting, instead of hopping through the juce::MessageThread.
+ * Snapshots are handed over through a TripleBuffer, which supports a single reading thread. Use a reader per thread
+ * which reads. The reader has its own ballistics, so readers don't influence each other or other subscribers.
+ */
+class LevelMeterSnapshotReader : LevelMeter::Subscriber
+{
+public:
+    /**
+     * The state of a single channel.
+     */
+    struct ChannelSnapshot
+    {
+        /// The peak level, with ballistics applied.
+        double peakLevel = 0.0;
+
+        /// The peak hold level.
+        double peakHoldLevel = 0.0;
+
+        /// True if the signal was overloaded at some point since the reader subscribed or resetOverloaded() was called.
+        bool overloaded = false;
+
+        /// The DC offset (the windowed mean of the signal).
+        double dcOffset = 0.0;
+
+        /// The ratio of peak to RMS level, or 0 if the signal is silent.
+        double crestFactor = 0.0;
+
+        /// The number of NaN, infinite and denormal samples since the reader subscribed.
+        InvalidSampleCounts invalidSamples;
+    };
+
+    /**
+     * The state of all channels after a refresh.
+     */
+    struct Snapshot
+    {
+        /// Increases with every published snapshot, starting at 1. A snapshot with sequence number 0 is empty.
+        uint64_t sequenceNumber = 0;
+
+        /// The value of juce::Time::getMillisecondCounter() when the snapshot was taken.
+        uint32_t timeMs = 0;
+
+        /// The state of every channel.
+        std::vector<ChannelSnapshot> channels;
+    };
+
+    /**
+     * Constructor.
+     * @param levelMeter The level meter to read.
+     * @param scale The scale, which defines minus infinity for the ballistics.
+     * @param maxChannels Defines the max number of channels. If a meter has more channels then all channels will be
+     * folded into a single mono channel.
+     */
+    explicit LevelMeterSnapshotReader (
+        LevelMeter& levelMeter,
+        const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale(),
+        int maxChannels = kDefaultMaxChannels);
+
+    ~LevelMeterSnapshotReader() override;
+
+    /**
+     * Picks up the latest published snapshot. This is lock-free and wait-free, but must only be called from a single
+     * thread at a time.
+     * @return The latest snapshot, which stays valid until the next call to read().
+     */
+    const Snapshot& read();
+
+    /**
+     * Turns off the overloaded flag of all channels, like LevelMeter::Subscriber::resetOverloaded(). Snapshots which
+     * are published after this call show the reset. Can be called from any thread.
+     */
+    void resetOverloaded();
+
+private:
+    TripleBuffer<Snapshot> mSnapshots;
+    uint64_t mNextSequenceNumber { 1 };
+
+    // MARK: LevelMeter::Subscriber overrides -
+    void measurementUpdatesFinished() override;
+    void levelMeterPrepared (int numChannels) override;
+};
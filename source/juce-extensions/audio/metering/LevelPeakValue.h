@@ -1,7 +1,9 @@
 #pragma once
 
+#include "FastDecibels.h"
 #include "LevelMeterConstants.h"
 
+#include <cmath>
 #include <cstdint>
 #include <juce_audio_basics/juce_audio_basics.h>
 #include <juce_core/juce_core.h>
@@ -16,7 +18,8 @@ class LevelPeakValue
 {
 public:
     explicit LevelPeakValue (double const minusInfinityDb = LevelMeterConstants::kDefaultMinusInfinityDb) :
-        mMinusInfinityDb (minusInfinityDb)
+        mMinusInfinityDb (minusInfinityDb),
+        mMinusInfinityGain (calculateMinusInfinityGain (minusInfinityDb))
     {
     }
 
@@ -45,20 +48,75 @@ public:
         }
     }
 
+    /**
+     * Catches up with a level which happened some time ago, as if it was passed to updateLevel() back then. Use this to
+     * restore the ballistics of a meter which wasn't updated for a while. Only a higher level will actually change
+     * anything.
+     * @param level The level.
+     * @param ageMs The time since the level happened, in milliseconds.
+     */
+    void catchUp (SampleType level, uint32_t const ageMs)
+    {
+        auto const caughtUpLevel = getCaughtUpLevel (level, ageMs);
+
+        if (caughtUpLevel > mReturningLevel)
+        {
+            mReturningLevel = caughtUpLevel;
+            mPeakHoldTimeLeft = mPeakHoldTime > ageMs ? mPeakHoldTime - ageMs : 0;
+        }
+
+        // Start counting time from now, the time before was taken into account above.
+        mPreviousTime = juce::Time::getMillisecondCounter();
+    }
+
+    /**
+     * @param level A level which happened some time ago.
+     * @param ageMs The time since the level happened, in milliseconds.
+     * @return The level a meter shows now for given level, after the hold time and the return rate of this value.
+     */
+    [[nodiscard]] SampleType getCaughtUpLevel (SampleType level, uint32_t const ageMs) const
+    {
+        auto const holdTimeLeft = mPeakHoldTime > ageMs ? mPeakHoldTime - ageMs : 0;
+        auto const declineTimeMs = ageMs - (mPeakHoldTime - holdTimeLeft);
+        SampleType declineDb = declineTimeMs / 1000.0 * mReturnRateDbPerSecond;
+
+        return level * FastDecibels::decibelsToGain (-declineDb, static_cast<SampleType> (mMinusInfinityDb));
+    }
+
     /**
      * Gets the next level to show on a meter, taking into account the return rate. The level will be calculated for
      * this point in time using a monotonic system clock.
      * @return The level for this point in time.
      */
     SampleType getNextLevel()
+    {
+        auto const declineDb = advanceTime();
+        return getNextLevel (FastDecibels::decibelsToGain (declineDb, static_cast<SampleType> (mMinusInfinityDb)));
+    }
+
+    /**
+     * First half of getNextLevel(), for converting the declines of many values in a single batch: advances the hold
+     * time to this point in time. Convert the result with FastDecibels::decibelsToGains() and pass it to
+     * getNextLevel (SampleType).
+     * @return The decline since the previous call, as a level in decibels at or below 0 dB.
+     */
+    SampleType advanceTime()
     {
         auto deltaTime = getDeltaTime();
         SampleType declineDb = deltaTime / 1000.0 * mReturnRateDbPerSecond;
 
-        auto declineGain = juce::Decibels::decibelsToGain (-declineDb, mMinusInfinityDb);
-
         mPeakHoldTimeLeft = mPeakHoldTimeLeft > deltaTime ? mPeakHoldTimeLeft - deltaTime : 0;
 
+        return -declineDb;
+    }
+
+    /**
+     * Second half of getNextLevel(), see advanceTime().
+     * @param declineGain The decline returned by advanceTime(), converted to a gain.
+     * @return The level for this point in time.
+     */
+    SampleType getNextLevel (SampleType declineGain)
+    {
         if (mPeakHoldTimeLeft == 0)
             mReturningLevel *= declineGain;
 
@@ -71,6 +129,15 @@ public:
         return mReturningLevel;
     }
 
+    /**
+     * @return True if the level has returned to minus infinity and no higher level is waiting to be returned, which
+     * means getNextLevel() won't return anything visible until the level is updated again.
+     */
+    [[nodiscard]] bool isSettled() const
+    {
+        return mHighestLevel <= SampleType {} && mReturningLevel <= mMinusInfinityGain;
+    }
+
     /**
      * Sets minus infinity.
      * @param minusInfinityDb The level in decibels which equals zero gain.
@@ -78,6 +145,7 @@ public:
     void setMinusInfinityDb (double minusInfinityDb)
     {
         mMinusInfinityDb = minusInfinityDb;
+        mMinusInfinityGain = calculateMinusInfinityGain (minusInfinityDb);
     }
 
     /**
@@ -117,12 +185,20 @@ private:
     /// Specifies the lowest level of audio which equals to zero gain.
     double mMinusInfinityDb = { LevelMeterConstants::kDefaultMinusInfinityDb };
 
+    /// The gain belonging to mMinusInfinityDb, below which the level counts as settled.
+    SampleType mMinusInfinityGain { 0.0 };
+
     /// Runtime setting for the amount of time the value needs to be held at the highest value.
     uint32_t mPeakHoldTime { 0 };
 
     /// Keeps track of the time the value still needs to hold.
     uint32_t mPeakHoldTimeLeft { 0 };
 
+    static SampleType calculateMinusInfinityGain (double const minusInfinityDb)
+    {
+        return static_cast<SampleType> (std::pow (10.0, minusInfinityDb * 0.05));
+    }
+
     /**
      * @return The amount of time (in milliseconds) since the previous call to this method.
      */
@@ -0,0 +1,832 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#if JUCE_USE_SSE_INTRINSICS
+    #include <emmintrin.h>
+#endif
+
+/**
+ * The measurement kernel of the level meter. Measures a channel of audio in a single pass over memory, in chunks of
+ * kChunkSize samples. For every chunk a bit mask is created of the samples which are at or above a threshold, so that
+ * clip detection can work on bit masks instead of on individual samples.
+ * In the same pass, samples are classified as NaN, infinite or denormal. Classification looks at the bits of the
+ * samples, so it also works when denormals are flushed to zero by the CPU. NaN and infinite samples are left out of the
+ * peak and the sums.
+ * Integer and interleaved PCM input is measured in the same way: every chunk of a channel is decoded into kChunkSize
+ * floats on the stack, which stay in cache, and measured by the float kernel. No conversion buffer is needed.
+ * Contiguous int16, int24in32 and int32 samples in native byte order are decoded with SSE2 where available.
+ * Interleaved frames are best measured with measureInterleaved(), which decodes all channels of a chunk of frames at
+ * once and deinterleaves them with SSE shuffles, so that the frames are read from memory only once.
+ */
+class MeasurementKernel
+{
+public:
+    /// The number of samples per chunk, which equals the number of bits of a mask.
+    static constexpr int kChunkSize = 64;
+
+    /// The number of channels of interleaved frames which are decoded together, which bounds the use of the stack.
+    static constexpr int kMaxChannelsPerPass = 8;
+
+    /**
+     * The result of measuring a channel.
+     */
+    struct Result
+    {
+        /// The highest absolute (finite) sample value.
+        double peak = 0.0;
+
+        /// The sum of all (finite) samples.
+        double sum = 0.0;
+
+        /// The sum of all squared (finite) samples.
+        double sumSquares = 0.0;
+
+        /// The number of NaN samples.
+        int numNaNs = 0;
+
+        /// The number of infinite samples.
+        int numInfs = 0;
+
+        /// The number of denormal samples.
+        int numDenormals = 0;
+    };
+
+    /**
+     * The encoding of PCM samples, matching the sample formats of juce::AudioData.
+     */
+    enum class PcmEncoding
+    {
+        int8,
+        uint8,
+        int16,
+        int24,
+        int24in32,
+        int32,
+        float32
+    };
+
+    /**
+     * The format of PCM samples.
+     */
+    struct PcmFormat
+    {
+        /// The encoding of a single sample.
+        PcmEncoding encoding = PcmEncoding::float32;
+
+        /// True if the bytes of a sample are stored big endian, false for little endian.
+        bool isBigEndian = juce::ByteOrder::isBigEndian();
+
+        /**
+         * @return The number of bytes of a single sample.
+         */
+        [[nodiscard]] constexpr int getBytesPerSample() const
+        {
+            switch (encoding)
+            {
+                case PcmEncoding::int8:
+                case PcmEncoding::uint8:
+                    return 1;
+                case PcmEncoding::int16:
+                    return 2;
+                case PcmEncoding::int24:
+                    return 3;
+                case PcmEncoding::int24in32:
+                case PcmEncoding::int32:
+                case PcmEncoding::float32:
+                    return 4;
+            }
+
+            return 0;
+        }
+
+        /**
+         * @return True if the samples can be read as floats without decoding.
+         */
+        [[nodiscard]] constexpr bool isNativeFloat() const
+        {
+            return encoding == PcmEncoding::float32 && isBigEndian == juce::ByteOrder::isBigEndian();
+        }
+
+        /**
+         * @return The highest absolute level a sample can have, where full scale is 1. The largest positive code of an
+         * integer encoding is one step below full scale, for example 32767 / 32768 for int16.
+         */
+        [[nodiscard]] constexpr float getMaxLevel() const
+        {
+            switch (encoding)
+            {
+                case PcmEncoding::int8:
+                case PcmEncoding::uint8:
+                    return 127.f / 128.f;
+                case PcmEncoding::int16:
+                    return 32767.f / 32768.f;
+                case PcmEncoding::int24:
+                case PcmEncoding::int24in32:
+                    return 8388607.f / 8388608.f;
+                case PcmEncoding::int32:
+                    return static_cast<float> (2147483647.0 / 2147483648.0);
+                case PcmEncoding::float32:
+                    return std::numeric_limits<float>::max();
+            }
+
+            return std::numeric_limits<float>::max();
+        }
+    };
+
+    /**
+     * Measures a channel of audio.
+     * @tparam SampleType The type of the samples.
+     * @tparam MaskCallback Callable as void (uint64_t mask, const SampleType* chunk, int offset, int length), which
+     * gets called for every chunk. Bit i of the mask is set when the absolute value of sample offset + i is at or above
+     * the threshold.
+     * @param channelData The samples to measure.
+     * @param numSamples The number of samples.
+     * @param threshold The threshold for the mask.
+     * @param onMask The callback which receives the mask of every chunk.
+     * @return The result.
+     */
+    template <typename SampleType, typename MaskCallback>
+    static Result measure (const SampleType* channelData, int numSamples, SampleType threshold, MaskCallback&& onMask)
+    {
+        Result result;
+
+        for (int offset = 0; offset < numSamples; offset += kChunkSize)
+        {
+            auto const length = juce::jmin (kChunkSize, numSamples - offset);
+            auto const chunk = measureChunk (channelData + offset, length, threshold);
+
+            accumulate (result, chunk);
+            onMask (chunk.clipMask, channelData + offset, offset, length);
+        }
+
+        return result;
+    }
+
+    /**
+     * Measures a channel of PCM samples, which may be interleaved with other channels.
+     * @tparam MaskCallback Callable as void (uint64_t mask, const float* chunk, int offset, int length), which gets
+     * called for every chunk with the decoded samples. Bit i of the mask is set when the absolute value of sample
+     * offset + i is at or above the threshold.
+     * @param channelData The first sample of the channel.
+     * @param stride The distance in bytes between two samples of the channel.
+     * @param numSamples The number of samples.
+     * @param format The format of the samples.
+     * @param threshold The threshold for the mask, where full scale is 1.
+     * @param onMask The callback which receives the mask of every chunk.
+     * @return The result, where full scale is 1.
+     */
+    template <typename MaskCallback>
+    static Result measurePcm (
+        const void* channelData,
+        size_t stride,
+        int numSamples,
+        PcmFormat format,
+        float threshold,
+        MaskCallback&& onMask)
+    {
+        auto const* data = static_cast<const uint8_t*> (channelData);
+
+        if (format.isBigEndian != juce::ByteOrder::isBigEndian())
+            return measurePcm<true> (data, stride, numSamples, format.encoding, threshold, onMask);
+
+        return measurePcm<false> (data, stride, numSamples, format.encoding, threshold, onMask);
+    }
+
+    /**
+     * Measures consecutive channels of interleaved PCM frames in a single pass over memory. Every chunk of kChunkSize
+     * frames is decoded for all channels and deinterleaved into kChunkSize floats per channel on the stack, which are
+     * measured by the float kernel. Channels are decoded in groups of kMaxChannelsPerPass, while the frames of the
+     * chunk stay in cache.
+     * @tparam MaskCallback Callable as void (int channel, uint64_t mask, const float* chunk, int offset, int length),
+     * which gets called for every chunk of every channel with the decoded samples. Bit i of the mask is set when the
+     * absolute value of sample offset + i is at or above the threshold.
+     * @param data The first sample of the first channel to measure.
+     * @param frameStride The distance in bytes between two frames.
+     * @param numChannels The number of channels to measure, starting at the first channel.
+     * @param numFrames The number of frames.
+     * @param format The format of the samples.
+     * @param threshold The threshold for the mask, where full scale is 1.
+     * @param results Receives the result of every channel, where full scale is 1. Must hold numChannels results.
+     * @param onMask The callback which receives the mask of every chunk.
+     */
+    template <typename MaskCallback>
+    static void measureInterleaved (
+        const void* data,
+        size_t frameStride,
+        int numChannels,
+        int numFrames,
+        PcmFormat format,
+        float threshold,
+        Result* results,
+        MaskCallback&& onMask)
+    {
+        auto const* frames = static_cast<const uint8_t*> (data);
+
+        if (format.isBigEndian != juce::ByteOrder::isBigEndian())
+        {
+            measureInterleaved<true> (
+                frames, frameStride, numChannels, numFrames, format.encoding, threshold, results, onMask);
+            return;
+        }
+
+        measureInterleaved<false> (
+            frames, frameStride, numChannels, numFrames, format.encoding, threshold, results, onMask);
+    }
+
+private:
+    struct ChunkResult
+    {
+        double peak = 0.0;
+        double sum = 0.0;
+        double sumSquares = 0.0;
+        uint64_t clipMask = 0;
+        uint64_t nanMask = 0;
+        uint64_t infMask = 0;
+        uint64_t denormalMask = 0;
+    };
+
+    static void accumulate (Result& result, const ChunkResult& chunk)
+    {
+        result.peak = juce::jmax (result.peak, chunk.peak);
+        result.sum += chunk.sum;
+        result.sumSquares += chunk.sumSquares;
+
+        if ((chunk.nanMask | chunk.infMask | chunk.denormalMask) != 0)
+        {
+            result.numNaNs += juce::countNumberOfBits (static_cast<juce::uint64> (chunk.nanMask));
+            result.numInfs += juce::countNumberOfBits (static_cast<juce::uint64> (chunk.infMask));
+            result.numDenormals += juce::countNumberOfBits (static_cast<juce::uint64> (chunk.denormalMask));
+        }
+    }
+
+    template <bool kSwapBytes, typename MaskCallback>
+    static Result measurePcm (
+        const uint8_t* data,
+        size_t const stride,
+        int const numSamples,
+        PcmEncoding const encoding,
+        float const threshold,
+        MaskCallback& onMask)
+    {
+        switch (encoding)
+        {
+            case PcmEncoding::int8:
+                return measureDecoded<PcmEncoding::int8, kSwapBytes> (data, stride, numSamples, threshold, onMask);
+            case PcmEncoding::uint8:
+                return measureDecoded<PcmEncoding::uint8, kSwapBytes> (data, stride, numSamples, threshold, onMask);
+            case PcmEncoding::int16:
+                return measureDecoded<PcmEncoding::int16, kSwapBytes> (data, stride, numSamples, threshold, onMask);
+            case PcmEncoding::int24:
+                return measureDecoded<PcmEncoding::int24, kSwapBytes> (data, stride, numSamples, threshold, onMask);
+            case PcmEncoding::int24in32:
+                return measureDecoded<PcmEncoding::int24in32, kSwapBytes> (data, stride, numSamples, threshold, onMask);
+            case PcmEncoding::int32:
+                return measureDecoded<PcmEncoding::int32, kSwapBytes> (data, stride, numSamples, threshold, onMask);
+            case PcmEncoding::float32:
+                return measureDecoded<PcmEncoding::float32, kSwapBytes> (data, stride, numSamples, threshold, onMask);
+        }
+
+        return {};
+    }
+
+    template <bool kSwapBytes, typename MaskCallback>
+    static void measureInterleaved (
+        const uint8_t* frames,
+        size_t const frameStride,
+        int const numChannels,
+        int const numFrames,
+        PcmEncoding const encoding,
+        float const threshold,
+        Result* results,
+        MaskCallback& onMask)
+    {
+        switch (encoding)
+        {
+            case PcmEncoding::int8:
+                measureInterleavedDecoded<PcmEncoding::int8, kSwapBytes> (
+                    frames, frameStride, numChannels, numFrames, threshold, results, onMask);
+                return;
+            case PcmEncoding::uint8:
+                measureInterleavedDecoded<PcmEncoding::uint8, kSwapBytes> (
+                    frames, frameStride, numChannels, numFrames, threshold, results, onMask);
+                return;
+            case PcmEncoding::int16:
+                measureInterleavedDecoded<PcmEncoding::int16, kSwapBytes> (
+                    frames, frameStride, numChannels, numFrames, threshold, results, onMask);
+                return;
+            case PcmEncoding::int24:
+                measureInterleavedDecoded<PcmEncoding::int24, kSwapBytes> (
+                    frames, frameStride, numChannels, numFrames, threshold, results, onMask);
+                return;
+            case PcmEncoding::int24in32:
+                measureInterleavedDecoded<PcmEncoding::int24in32, kSwapBytes> (
+                    frames, frameStride, numChannels, numFrames, threshold, results, onMask);
+                return;
+            case PcmEncoding::int32:
+                measureInterleavedDecoded<PcmEncoding::int32, kSwapBytes> (
+                    frames, frameStride, numChannels, numFrames, threshold, results, onMask);
+                return;
+            case PcmEncoding::float32:
+                measureInterleavedDecoded<PcmEncoding::float32, kSwapBytes> (
+                    frames, frameStride, numChannels, numFrames, threshold, results, onMask);
+                return;
+        }
+    }
+
+    /**
+     * Decodes every chunk of frames into floats on the stack, a group of channels at a time, and measures every channel
+     * with the float kernel.
+     */
+    template <PcmEncoding kEncoding, bool kSwapBytes, typename MaskCallback>
+    static void measureInterleavedDecoded (
+        const uint8_t* frames,
+        size_t const frameStride,
+        int const numChannels,
+        int const numFrames,
+        float const threshold,
+        Result* results,
+        MaskCallback& onMask)
+    {
+        constexpr auto kBytesPerSample = static_cast<size_t> (PcmFormat { kEncoding }.getBytesPerSample());
+
+        float interleaved[kChunkSize * kMaxChannelsPerPass];
+        float decoded[kChunkSize * kMaxChannelsPerPass];
+
+        std::fill (results, results + numChannels, Result {});
+
+        for (int offset = 0; offset < numFrames; offset += kChunkSize)
+        {
+            auto const length = juce::jmin (kChunkSize, numFrames - offset);
+            auto const* chunkFrames = frames + static_cast<size_t> (offset) * frameStride;
+
+            for (int firstChannel = 0; firstChannel < numChannels; firstChannel += kMaxChannelsPerPass)
+            {
+                auto const numGroupChannels = juce::jmin (kMaxChannelsPerPass, numChannels - firstChannel);
+                auto const* x = chunkFrames + static_cast<size_t> (firstChannel) * kBytesPerSample;
+
+                if constexpr (kEncoding == PcmEncoding::float32 && !kSwapBytes)
+                {
+                    // Native floats don't need decoding, so they are deinterleaved straight from the frames.
+                    if (frameStride % sizeof (float) == 0)
+                    {
+                        auto const* samples = reinterpret_cast<const float*> (x);
+                        auto const sampleStride = static_cast<int> (frameStride / sizeof (float));
+                        deinterleave (samples, sampleStride, numGroupChannels, length, decoded);
+                        measureDeinterleaved (
+                            decoded, firstChannel, numGroupChannels, offset, length, threshold, results, onMask);
+                        continue;
+                    }
+                }
+
+                // The samples of a group are contiguous within a frame, and across frames when the group holds every
+                // channel of the frames.
+                if (frameStride == kBytesPerSample * static_cast<size_t> (numGroupChannels))
+                {
+                    decodeChunk<kEncoding, kSwapBytes> (x, kBytesPerSample, length * numGroupChannels, interleaved);
+                }
+                else
+                {
+                    for (int i = 0; i < length; ++i)
+                    {
+                        decodeChunk<kEncoding, kSwapBytes> (
+                            x + static_cast<size_t> (i) * frameStride,
+                            kBytesPerSample,
+                            numGroupChannels,
+                            interleaved + i * numGroupChannels);
+                    }
+                }
+
+                deinterleave (interleaved, numGroupChannels, numGroupChannels, length, decoded);
+                measureDeinterleaved (
+                    decoded, firstChannel, numGroupChannels, offset, length, threshold, results, onMask);
+            }
+        }
+    }
+
+    /**
+     * Measures the deinterleaved chunks of a group of channels with the float kernel.
+     */
+    template <typename MaskCallback>
+    static void measureDeinterleaved (
+        const float* decoded,
+        int const firstChannel,
+        int const numGroupChannels,
+        int const offset,
+        int const length,
+        float const threshold,
+        Result* results,
+        MaskCallback& onMask)
+    {
+        for (int ch = 0; ch < numGroupChannels; ++ch)
+        {
+            const float* channelChunk = decoded + ch * kChunkSize;
+            auto const chunk = measureChunk (channelChunk, length, threshold);
+
+            accumulate (results[firstChannel + ch], chunk);
+            onMask (firstChannel + ch, chunk.clipMask, channelChunk, offset, length);
+        }
+    }
+
+    /**
+     * Deinterleaves frames into kChunkSize samples per channel. Stereo frames and groups with a multiple of 4 channels
+     * are shuffled with SSE where available, the rest sample by sample.
+     * @param interleaved The first sample of the first channel of the first frame.
+     * @param frameStride The distance in samples between two frames.
+     * @param numChannels The number of channels to deinterleave.
+     * @param numFrames The number of frames.
+     * @param channels Receives kChunkSize samples per channel.
+     */
+    static void deinterleave (
+        const float* interleaved,
+        int const frameStride,
+        int const numChannels,
+        int const numFrames,
+        float* channels)
+    {
+        if (numChannels == 1 && frameStride == 1)
+        {
+            std::memcpy (channels, interleaved, static_cast<size_t> (numFrames) * sizeof (float));
+            return;
+        }
+
+        int i = 0;
+
+#if JUCE_USE_SSE_INTRINSICS
+        if (numChannels == 2 && frameStride == 2)
+        {
+            for (; i + 4 <= numFrames; i += 4)
+            {
+                auto const a = _mm_loadu_ps (interleaved + i * 2);
+                auto const b = _mm_loadu_ps (interleaved + i * 2 + 4);
+                _mm_storeu_ps (channels + i, _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0)));
+                _mm_storeu_ps (channels + kChunkSize + i, _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1)));
+            }
+        }
+        else if (numChannels % 4 == 0)
+        {
+            // Transposes blocks of 4 frames by 4 channels.
+            for (; i + 4 <= numFrames; i += 4)
+            {
+                for (int ch = 0; ch < numChannels; ch += 4)
+                {
+                    auto r0 = _mm_loadu_ps (interleaved + (i + 0) * frameStride + ch);
+                    auto r1 = _mm_loadu_ps (interleaved + (i + 1) * frameStride + ch);
+                    auto r2 = _mm_loadu_ps (interleaved + (i + 2) * frameStride + ch);
+                    auto r3 = _mm_loadu_ps (interleaved + (i + 3) * frameStride + ch);
+                    _MM_TRANSPOSE4_PS (r0, r1, r2, r3);
+                    _mm_storeu_ps (channels + (ch + 0) * kChunkSize + i, r0);
+                    _mm_storeu_ps (channels + (ch + 1) * kChunkSize + i, r1);
+                    _mm_storeu_ps (channels + (ch + 2) * kChunkSize + i, r2);
+                    _mm_storeu_ps (channels + (ch + 3) * kChunkSize + i, r3);
+                }
+            }
+        }
+#endif
+
+        for (; i < numFrames; ++i)
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch * kChunkSize + i] = interleaved[i * frameStride + ch];
+        }
+    }
+
+    /**
+     * Decodes every chunk of a channel into floats on the stack, and measures it with the float kernel.
+     */
+    template <PcmEncoding kEncoding, bool kSwapBytes, typename MaskCallback>
+    static Result measureDecoded (
+        const uint8_t* data,
+        size_t const stride,
+        int const numSamples,
+        float const threshold,
+        MaskCallback& onMask)
+    {
+        Result result;
+        float decoded[kChunkSize];
+
+        for (int offset = 0; offset < numSamples; offset += kChunkSize)
+        {
+            auto const length = juce::jmin (kChunkSize, numSamples - offset);
+            auto const* x = data + static_cast<size_t> (offset) * stride;
+
+            decodeChunk<kEncoding, kSwapBytes> (x, stride, length, decoded);
+
+            auto const chunk = measureChunk (decoded, length, threshold);
+
+            accumulate (result, chunk);
+            onMask (chunk.clipMask, static_cast<const float*> (decoded), offset, length);
+        }
+
+        return result;
+    }
+
+    /**
+     * Decodes a run of samples into floats, where full scale is 1.
+     */
+    template <PcmEncoding kEncoding, bool kSwapBytes>
+    static void decodeChunk (const uint8_t* x, size_t const stride, int const length, float* decoded)
+    {
+        if constexpr (kEncoding == PcmEncoding::float32 && !kSwapBytes)
+        {
+            // Contiguous native floats only need copying.
+            if (stride == sizeof (float))
+            {
+                std::memcpy (decoded, x, static_cast<size_t> (length) * sizeof (float));
+                return;
+            }
+        }
+
+        int i = 0;
+
+#if JUCE_USE_SSE_INTRINSICS
+        // Contiguous integer samples in native byte order are decoded with SSE2, the rest sample by sample.
+        constexpr bool kHasSSE = kEncoding == PcmEncoding::int16 || kEncoding == PcmEncoding::int24in32
+                                 || kEncoding == PcmEncoding::int32;
+
+        if constexpr (kHasSSE && !kSwapBytes)
+        {
+            if (stride == static_cast<size_t> (PcmFormat { kEncoding }.getBytesPerSample()))
+                i = decodeChunkSSE<kEncoding> (x, length, decoded);
+        }
+#endif
+
+        for (; i < length; ++i)
+            decoded[i] = decodeSample<kEncoding, kSwapBytes> (x + static_cast<size_t> (i) * stride);
+    }
+
+#if JUCE_USE_SSE_INTRINSICS
+    /**
+     * Decodes contiguous integer samples in native byte order.
+     * @return The number of decoded samples, the remaining samples must be decoded by decodeSample().
+     */
+    template <PcmEncoding kEncoding>
+    static int decodeChunkSSE (const uint8_t* x, int const length, float* decoded)
+    {
+        int i = 0;
+
+        if constexpr (kEncoding == PcmEncoding::int16)
+        {
+            auto const scale = _mm_set1_ps (1.f / 32768.f);
+
+            for (; i + 8 <= length; i += 8)
+            {
+                auto const v = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (x + i * 2));
+
+                // Move every sample into the upper half of a 32 bit lane, and shift it back down keeping its sign.
+                auto const low = _mm_srai_epi32 (_mm_unpacklo_epi16 (v, v), 16);
+                auto const high = _mm_srai_epi32 (_mm_unpackhi_epi16 (v, v), 16);
+
+                _mm_storeu_ps (decoded + i, _mm_mul_ps (_mm_cvtepi32_ps (low), scale));
+                _mm_storeu_ps (decoded + i + 4, _mm_mul_ps (_mm_cvtepi32_ps (high), scale));
+            }
+        }
+        else
+        {
+            auto const scale = _mm_set1_ps (kEncoding == PcmEncoding::int32 ? 1.f / 2147483648.f : 1.f / 8388608.f);
+
+            for (; i + 4 <= length; i += 4)
+            {
+                auto const v = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (x + i * 4));
+                _mm_storeu_ps (decoded + i, _mm_mul_ps (_mm_cvtepi32_ps (v), scale));
+            }
+        }
+
+        return i;
+    }
+#endif
+
+    /**
+     * @return A single sample converted to float, where full scale is 1.
+     */
+    template <PcmEncoding kEncoding, bool kSwapBytes>
+    static float decodeSample (const uint8_t* p)
+    {
+        if constexpr (kEncoding == PcmEncoding::int8)
+        {
+            return static_cast<float> (static_cast<int8_t> (p[0])) * (1.f / 128.f);
+        }
+        else if constexpr (kEncoding == PcmEncoding::uint8)
+        {
+            return static_cast<float> (static_cast<int> (p[0]) - 128) * (1.f / 128.f);
+        }
+        else if constexpr (kEncoding == PcmEncoding::int16)
+        {
+            uint16_t bits;
+            std::memcpy (&bits, p, sizeof (bits));
+            if constexpr (kSwapBytes)
+                bits = juce::ByteOrder::swap (bits);
+            return static_cast<float> (static_cast<int16_t> (bits)) * (1.f / 32768.f);
+        }
+        else if constexpr (kEncoding == PcmEncoding::int24)
+        {
+            // Packed samples are 3 bytes, so they are assembled byte by byte.
+            auto const littleEndian = juce::ByteOrder::isBigEndian() == kSwapBytes;
+            auto const value =
+                littleEndian ? juce::ByteOrder::littleEndian24Bit (p) : juce::ByteOrder::bigEndian24Bit (p);
+            return static_cast<float> (value) * (1.f / 8388608.f);
+        }
+        else
+        {
+            uint32_t bits;
+            std::memcpy (&bits, p, sizeof (bits));
+            if constexpr (kSwapBytes)
+                bits = juce::ByteOrder::swap (bits);
+
+            if constexpr (kEncoding == PcmEncoding::float32)
+            {
+                float value;
+                std::memcpy (&value, &bits, sizeof (value));
+                return value;
+            }
+            else if constexpr (kEncoding == PcmEncoding::int24in32)
+            {
+                return static_cast<float> (static_cast<int32_t> (bits)) * (1.f / 8388608.f);
+            }
+            else
+            {
+                return static_cast<float> (static_cast<int32_t> (bits)) * (1.f / 2147483648.f);
+            }
+        }
+    }
+
+    /// The bit layout of IEEE 754 samples.
+    template <typename SampleType>
+    struct SampleBits
+    {
+        static_assert (std::is_same_v<SampleType, float> || std::is_same_v<SampleType, double>);
+        static constexpr bool kIsFloat = std::is_same_v<SampleType, float>;
+
+        using Type = std::conditional_t<kIsFloat, uint32_t, uint64_t>;
+        static constexpr Type kAbsMask = kIsFloat ? Type (0x7fffffff) : Type (0x7fffffffffffffff);
+        static constexpr Type kExponentMask = kIsFloat ? Type (0x7f800000) : Type (0x7ff0000000000000);
+        static constexpr Type kMinNormal = kIsFloat ? Type (0x00800000) : Type (0x0010000000000000);
+    };
+
+    /**
+     * Generic implementation, written without branches so that compilers can vectorize it.
+     */
+    template <typename SampleType>
+    static ChunkResult measureChunkScalar (const SampleType* x, int begin, int end, SampleType threshold)
+    {
+        using Bits = SampleBits<SampleType>;
+
+        ChunkResult result;
+        SampleType peak = 0;
+        SampleType sum = 0;
+        SampleType sumSquares = 0;
+
+        for (int i = begin; i < end; ++i)
+        {
+            typename Bits::Type bits;
+            std::memcpy (&bits, x + i, sizeof (bits));
+            bits &= Bits::kAbsMask;
+
+            auto const isFinite = bits < Bits::kExponentMask;
+            auto const value = isFinite ? x[i] : SampleType (0);
+            auto const a = std::abs (value);
+
+            peak = a > peak ? a : peak;
+            sum += value;
+            sumSquares += value * value;
+
+            result.clipMask |= static_cast<uint64_t> (std::abs (x[i]) >= threshold) << i;
+            result.nanMask |= static_cast<uint64_t> (bits > Bits::kExponentMask) << i;
+            result.infMask |= static_cast<uint64_t> (bits == Bits::kExponentMask) << i;
+            result.denormalMask |= static_cast<uint64_t> (bits - 1 < Bits::kMinNormal - 1) << i; // 0 wraps around.
+        }
+
+        result.peak = static_cast<double> (peak);
+        result.sum = static_cast<double> (sum);
+        result.sumSquares = static_cast<double> (sumSquares);
+        return result;
+    }
+
+    template <typename SampleType>
+    static ChunkResult measureChunk (const SampleType* x, int length, SampleType threshold)
+    {
+        return measureChunkScalar (x, 0, length, threshold);
+    }
+
+#if JUCE_USE_SSE_INTRINSICS
+    static ChunkResult measureChunk (const float* x, int length, float threshold)
+    {
+        auto const absMask = _mm_castsi128_ps (_mm_set1_epi32 (0x7fffffff));
+        auto const exponentMask = _mm_set1_epi32 (0x7f800000);
+        auto const minNormal = _mm_set1_epi32 (0x00800000);
+        auto const zero = _mm_setzero_si128();
+        auto const vInf = _mm_castsi128_ps (exponentMask);
+        auto const vThreshold = _mm_set1_ps (threshold);
+        auto vPeak = _mm_setzero_ps();
+        auto vSum = _mm_setzero_ps();
+        auto vSumSquares = _mm_setzero_ps();
+        uint64_t clipMask = 0, nanMask = 0, infMask = 0, denormalMask = 0;
+
+        int i = 0;
+        for (; i + 4 <= length; i += 4)
+        {
+            auto const v = _mm_loadu_ps (x + i);
+            auto const a = _mm_and_ps (v, absMask);
+            auto const finite = _mm_cmplt_ps (a, vInf); // False for NaN and infinity.
+            auto const vFinite = _mm_and_ps (v, finite);
+
+            vPeak = _mm_max_ps (vPeak, _mm_and_ps (a, finite));
+            vSum = _mm_add_ps (vSum, vFinite);
+            vSumSquares = _mm_add_ps (vSumSquares, _mm_mul_ps (vFinite, vFinite));
+
+            auto const bits = _mm_castps_si128 (a);
+            auto const isNaN = _mm_cmpgt_epi32 (bits, exponentMask);
+            auto const isInf = _mm_cmpeq_epi32 (bits, exponentMask);
+            auto const isDenormal = _mm_andnot_si128 (_mm_cmpeq_epi32 (bits, zero), _mm_cmplt_epi32 (bits, minNormal));
+
+            clipMask |= static_cast<uint64_t> (_mm_movemask_ps (_mm_cmpge_ps (a, vThreshold))) << i;
+            nanMask |= static_cast<uint64_t> (_mm_movemask_ps (_mm_castsi128_ps (isNaN))) << i;
+            infMask |= static_cast<uint64_t> (_mm_movemask_ps (_mm_castsi128_ps (isInf))) << i;
+            denormalMask |= static_cast<uint64_t> (_mm_movemask_ps (_mm_castsi128_ps (isDenormal))) << i;
+        }
+
+        auto result = measureChunkScalar (x, i, length, threshold);
+
+        alignas (16) float peaks[4];
+        alignas (16) float sums[4];
+        alignas (16) float sumsSquares[4];
+        _mm_store_ps (peaks, vPeak);
+        _mm_store_ps (sums, vSum);
+        _mm_store_ps (sumsSquares, vSumSquares);
+
+        auto const peak = juce::jmax (peaks[0], peaks[1], peaks[2], peaks[3]);
+        result.peak = juce::jmax (result.peak, static_cast<double> (peak));
+        result.sum += static_cast<double> (sums[0] + sums[1] + sums[2] + sums[3]);
+        result.sumSquares += static_cast<double> (sumsSquares[0] + sumsSquares[1] + sumsSquares[2] + sumsSquares[3]);
+        result.clipMask |= clipMask;
+        result.nanMask |= nanMask;
+        result.infMask |= infMask;
+        result.denormalMask |= denormalMask;
+        return result;
+    }
+
+    static ChunkResult measureChunk (const double* x, int length, double threshold)
+    {
+        auto const absMask = _mm_castsi128_pd (_mm_set1_epi64x (0x7fffffffffffffff));
+        auto const exponentMask = _mm_set1_epi64x (0x7ff0000000000000);
+        auto const zero = _mm_setzero_si128();
+        auto const vInf = _mm_castsi128_pd (exponentMask);
+        auto const vThreshold = _mm_set1_pd (threshold);
+        auto vPeak = _mm_setzero_pd();
+        auto vSum = _mm_setzero_pd();
+        auto vSumSquares = _mm_setzero_pd();
+        uint64_t clipMask = 0, nanMask = 0, infMask = 0, denormalMask = 0;
+
+        int i = 0;
+        for (; i + 2 <= length; i += 2)
+        {
+            auto const v = _mm_loadu_pd (x + i);
+            auto const a = _mm_and_pd (v, absMask);
+            auto const finite = _mm_cmplt_pd (a, vInf); // False for NaN and infinity.
+            auto const vFinite = _mm_and_pd (v, finite);
+
+            vPeak = _mm_max_pd (vPeak, _mm_and_pd (a, finite));
+            vSum = _mm_add_pd (vSum, vFinite);
+            vSumSquares = _mm_add_pd (vSumSquares, _mm_mul_pd (vFinite, vFinite));
+
+            // SSE2 has no 64 bit integer compares. The high 32 bits of each lane decide the movemask, so compare the
+            // exponent in 32 bit lanes and combine both halves for the zero test.
+            auto const bits = _mm_castpd_si128 (a);
+            auto const exponentIsZero = _mm_cmpeq_epi32 (_mm_and_si128 (bits, exponentMask), zero);
+            auto const halvesAreZero = _mm_cmpeq_epi32 (bits, zero);
+            auto const swappedHalves = _mm_shuffle_epi32 (halvesAreZero, _MM_SHUFFLE (2, 3, 0, 1));
+            auto const isZero = _mm_and_si128 (halvesAreZero, swappedHalves);
+            auto const isDenormal = _mm_andnot_si128 (isZero, exponentIsZero);
+
+            clipMask |= static_cast<uint64_t> (_mm_movemask_pd (_mm_cmpge_pd (a, vThreshold))) << i;
+            nanMask |= static_cast<uint64_t> (_mm_movemask_pd (_mm_cmpunord_pd (v, v))) << i;
+            infMask |= static_cast<uint64_t> (_mm_movemask_pd (_mm_cmpeq_pd (a, vInf))) << i;
+            denormalMask |= static_cast<uint64_t> (_mm_movemask_pd (_mm_castsi128_pd (isDenormal))) << i;
+        }
+
+        auto result = measureChunkScalar (x, i, length, threshold);
+
+        alignas (16) double peaks[2];
+        alignas (16) double sums[2];
+        alignas (16) double sumsSquares[2];
+        _mm_store_pd (peaks, vPeak);
+        _mm_store_pd (sums, vSum);
+        _mm_store_pd (sumsSquares, vSumSquares);
+
+        result.peak = juce::jmax (result.peak, peaks[0], peaks[1]);
+        result.sum += sums[0] + sums[1];
+        result.sumSquares += sumsSquares[0] + sumsSquares[1];
+        result.clipMask |= clipMask;
+        result.nanMask |= nanMask;
+        result.infMask |= infMask;
+        result.denormalMask |= denormalMask;
+        return result;
+    }
+#endif
+};
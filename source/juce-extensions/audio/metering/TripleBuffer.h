@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Hands over values from a single producer thread to a single consumer thread, without locking and without waiting.
+ * The producer writes into its own buffer and publishes it, the consumer picks up the most recently published buffer.
+ * Values which are published while the consumer doesn't pick them up are skipped, so the consumer always sees the
+ * latest complete value, and the producer never has to wait for the consumer.
+ * @tparam T The type of the value. Buffers are reused, so values which own memory (like a std::vector) only allocate
+ * when they grow.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    /**
+     * Constructor.
+     * @param initialValue The value to initialize all three buffers with.
+     */
+    explicit TripleBuffer (const T& initialValue) :
+        mBuffers { initialValue, initialValue, initialValue }
+    {
+    }
+
+    /**
+     * @return The buffer to write the next value into. Only call this from the producer thread.
+     */
+    T& getWriteBuffer()
+    {
+        return mBuffers[mWriteIndex];
+    }
+
+    /**
+     * Publishes the write buffer, after which getWriteBuffer() returns another buffer which holds an older value.
+     * Only call this from the producer thread.
+     */
+    void publish()
+    {
+        auto const previous = mMiddle.exchange (static_cast<uint8_t> (mWriteIndex | kNewValueBit));
+        mWriteIndex = static_cast<uint8_t> (previous & kIndexMask);
+    }
+
+    /**
+     * Picks up the most recently published value, if there is one which wasn't picked up before. Only call this from
+     * the consumer thread.
+     * @return True if a new value was picked up.
+     */
+    bool update()
+    {
+        if ((mMiddle.load (std::memory_order_relaxed) & kNewValueBit) == 0)
+            return false;
+
+        auto const previous = mMiddle.exchange (static_cast<uint8_t> (mReadIndex));
+        mReadIndex = static_cast<uint8_t> (previous & kIndexMask);
+        return true;
+    }
+
+    /**
+     * @return The value which was picked up by the last call to update(). Only call this from the consumer thread.
+     */
+    const T& getReadBuffer() const
+    {
+        return mBuffers[mReadIndex];
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kNewValueBit = 0x4;
+
+    std::array<T, 3> mBuffers {};
+
+    /// The index of the buffer which is not owned by either thread, and whether it holds a value not picked up yet.
+    std::atomic<uint8_t> mMiddle { 1 };
+
+    /// Owned by the producer.
+    uint8_t mWriteIndex { 0 };
+
+    /// Owned by the consumer.
+    uint8_t mReadIndex { 2 };
+};
@@ -12,8 +12,16 @@ LevelMeterComponent::Options LevelMeterComponent::Options::withMaxChannels (int
     return copy;
 }
 
-LevelMeterComponent::LevelMeterComponent (const LevelMeter::Scale& scale, [[maybe_unused]] const Options& options) :
-    Subscriber (scale, options.maxChannels)
+LevelMeterComponent::Options LevelMeterComponent::Options::withSegmentSize (int const newSegmentSize) const
+{
+    auto copy = *this;
+    copy.segmentSize = newSegmentSize;
+    return copy;
+}
+
+LevelMeterComponent::LevelMeterComponent (const LevelMeter::Scale& scale, const Options& options) :
+    Subscriber (scale, options.maxChannels),
+    mOptions (options)
 {
 }
 
@@ -26,113 +34,328 @@ LevelMeterComponent::LevelMeterComponent (
     subscribeToLevelMeter (levelMeter);
 }
 
+LevelMeterComponent::~LevelMeterComponent()
+{
+    // Unsubscribe before this object is partly destroyed, a refresh thread might be calling into it.
+    unsubscribeFromLevelMeter();
+    cancelPendingUpdate();
+}
+
+bool LevelMeterComponent::ChannelState::differsInLook (const ChannelState& other) const
+{
+    return hasNonFiniteSamples != other.hasNonFiniteSamples || isOverloaded != other.isOverloaded ||
+           hasDenormalSamples != other.hasDenormalSamples;
+}
+
 void LevelMeterComponent::measurementUpdatesFinished()
+{
+    auto const numChannels = getNumChannels();
+    const auto& scale = getScale();
+
+    auto& states = mRefreshedChannelStates.getWriteBuffer();
+    states.resize (static_cast<size_t> (numChannels));
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto& state = states[static_cast<size_t> (ch)];
+        state.peakProportion = scale.calculateProportionForLevel (getPeakValue (ch));
+        state.peakHoldProportion = scale.calculateProportionForLevel (getPeakHoldValue (ch));
+        state.hasNonFiniteSamples = hasNonFiniteSamples (ch);
+        state.isOverloaded = isOverloaded (ch); // Set by the clip detector of the level meter.
+        state.hasDenormalSamples = hasDenormalSamples (ch);
+    }
+
+    mRefreshedChannelStates.publish();
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        handleAsyncUpdate();
+    else
+        triggerAsyncUpdate();
+}
+
+void LevelMeterComponent::handleAsyncUpdate()
 {
     JUCE_ASSERT_MESSAGE_THREAD;
 
-    bool isSilent { true };
+    if (!mRefreshedChannelStates.update())
+        return;
+
+    const auto& states = mRefreshedChannelStates.getReadBuffer();
+
+    if (mChannelStates.size() != states.size())
+    {
+        mChannelStates.assign (states.size(), {});
+        repaint();
+    }
+
+    for (size_t ch = 0; ch < states.size(); ++ch)
+    {
+        repaintChangedAreas (static_cast<int> (ch), mChannelStates[ch], states[ch]);
+        mChannelStates[ch] = states[ch];
+    }
+}
+
+void LevelMeterComponent::repaintChangedAreas (
+    int const channelIndex,
+    const ChannelState& previous,
+    const ChannelState& current)
+{
+    auto const barBounds = getBarBounds (channelIndex);
+
+    if (previous.differsInLook (current))
+    {
+        repaint (barBounds.getSmallestIntegerContainer());
+        return;
+    }
+
+    auto const previousLevel = getLevelPosition (previous.peakProportion);
+    auto const currentLevel = getLevelPosition (current.peakProportion);
 
-    for (int ch = 0; ch < getNumChannels(); ++ch)
+    if (previousLevel != currentLevel)
     {
-        if (getScale().calculateProportionForLevel (std::max (getPeakValue (ch), getPeakHoldValue (ch))) > .001)
+        // The edge of the bar is anti-aliased, so include the pixels around both edges.
+        auto const delta = getBarSlice (
+            barBounds,
+            std::min (previousLevel, currentLevel) - 1.f,
+            std::max (previousLevel, currentLevel) + 1.f);
+        repaint (delta.getSmallestIntegerContainer());
+    }
+
+    auto const previousHold = juce::roundToInt (getLevelPosition (previous.peakHoldProportion));
+    auto const currentHold = juce::roundToInt (getLevelPosition (current.peakHoldProportion));
+
+    if (previousHold != currentHold)
+    {
+        for (auto const hold : { previousHold, currentHold })
         {
-            isSilent = false;
-            break;
+            auto const line = getBarSlice (barBounds, static_cast<float> (hold), static_cast<float> (hold + 1));
+            repaint (line.getSmallestIntegerContainer());
         }
     }
+}
 
-    if (!isSilent || !mWasSilent)
-        repaint();
+juce::Rectangle<float> LevelMeterComponent::getBarBounds (int const channelIndex) const
+{
+    auto const isHorizontal = getWidth() > getHeight();
+    auto const numChannels = std::max (1, static_cast<int> (mChannelStates.size()));
+    auto const meterBounds = getLocalBounds().toFloat();
+
+    auto const barSeparationSpace = 1.f;
+    auto const totalSize = isHorizontal ? meterBounds.getHeight() : meterBounds.getWidth();
+    float const barSize = (totalSize - (barSeparationSpace * static_cast<float> (numChannels - 1))) /
+                          static_cast<float> (numChannels);
+    auto const barStart = static_cast<float> (channelIndex) * (barSize + barSeparationSpace);
+
+    return isHorizontal ? meterBounds.withY (meterBounds.getY() + barStart).withHeight (barSize)
+                        : meterBounds.withX (meterBounds.getX() + barStart).withWidth (barSize);
+}
+
+float LevelMeterComponent::getLevelPosition (double const proportion) const
+{
+    auto const overloadAreaSize = static_cast<float> (kOverloadAreaSize);
+
+    if (getWidth() > getHeight())
+        return (static_cast<float> (getWidth()) - overloadAreaSize) * static_cast<float> (proportion);
 
-    mWasSilent = isSilent;
+    auto const height = static_cast<float> (getHeight());
+    return height - (height - overloadAreaSize) * static_cast<float> (proportion);
+}
+
+juce::Rectangle<float> LevelMeterComponent::getBarSlice (
+    juce::Rectangle<float> const barBounds,
+    float const start,
+    float const end) const
+{
+    if (getWidth() > getHeight())
+        return barBounds.withLeft (start).withRight (end);
+
+    return barBounds.withTop (start).withBottom (end);
 }
 
 void LevelMeterComponent::levelMeterPrepared ([[maybe_unused]] int numChannels)
 {
     JUCE_ASSERT_MESSAGE_THREAD;
+
+    mChannelStates.clear();
+    repaint();
+}
+
+void LevelMeterComponent::resetOverloaded()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    {
+        // The overloaded flags and invalid sample counts are updated by the thread which refreshes the level meter.
+        const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+        LevelMeter::Subscriber::resetOverloaded();
+        resetInvalidSamples();
+    }
+
+    for (size_t ch = 0; ch < mChannelStates.size(); ++ch)
+    {
+        auto const previous = mChannelStates[ch];
+        mChannelStates[ch].isOverloaded = false;
+        mChannelStates[ch].hasNonFiniteSamples = false;
+        mChannelStates[ch].hasDenormalSamples = false;
+        repaintChangedAreas (static_cast<int> (ch), previous, mChannelStates[ch]);
+    }
+}
+
+void LevelMeterComponent::mouseDown ([[maybe_unused]] const juce::MouseEvent& event)
+{
+    resetOverloaded();
 }
 
 void LevelMeterComponent::setOptions (const LevelMeterComponent::Options& options)
 {
     mOptions = options;
+    mBarImage = {};
     repaint();
 }
 
-void LevelMeterComponent::paint (juce::Graphics& g)
+void LevelMeterComponent::resized()
 {
-    auto isHorizontal = getWidth() > getHeight();
+    mBarImage = {};
+}
 
-    auto bounds = getLocalBounds();
-    auto meterBounds = bounds.toFloat();
+juce::Colour LevelMeterComponent::getZoneColour (double const levelDb) const
+{
+    if (levelDb >= mOptions.overloadStartPointDb)
+        return juce::Colours::red;
 
-    auto numChannels = getNumChannels();
+    if (levelDb >= mOptions.yellowStartPointDb)
+        return juce::Colours::gold;
 
-    auto barSeparationSpace = 1.f;
-    auto totalSize = isHorizontal ? meterBounds.getHeight() : meterBounds.getWidth();
-    float const barSize = (totalSize - (barSeparationSpace * static_cast<float> (numChannels - 1))) /
-                          static_cast<float> (numChannels);
+    return juce::Colours::darkgreen;
+}
+
+const juce::Image& LevelMeterComponent::getBarImage (float const scaleFactor)
+{
+    auto const width = juce::roundToInt (static_cast<float> (getWidth()) * scaleFactor);
+    auto const height = juce::roundToInt (static_cast<float> (getHeight()) * scaleFactor);
+
+    if (mBarImage.isValid() && mBarImage.getWidth() == width && mBarImage.getHeight() == height &&
+        mBarImageScaleFactor == scaleFactor)
+    {
+        return mBarImage;
+    }
 
+    mBarImage = juce::Image (juce::Image::ARGB, std::max (1, width), std::max (1, height), true);
+    mBarImageScaleFactor = scaleFactor;
+
+    juce::Graphics g (mBarImage);
+    g.addTransform (juce::AffineTransform::scale (scaleFactor));
+
+    auto const isHorizontal = getWidth() > getHeight();
+    auto const bounds = getLocalBounds().toFloat();
     const auto& scale = getScale();
 
-    // Draw level bars and peak hold values.
-    for (int ch = 0; ch < numChannels; ch++)
+    // Fill each zone with a gradient from a darker shade at its start to its colour at its end.
+    double const zoneStartsDb[] = { scale.calculateLevelDbForProportion (0.0),
+                                    mOptions.yellowStartPointDb,
+                                    mOptions.overloadStartPointDb,
+                                    scale.calculateLevelDbForProportion (1.0) };
+
+    for (size_t i = 0; i + 1 < std::size (zoneStartsDb); ++i)
     {
-        auto const peak = getPeakValue (ch);
-        auto const peakProportion = scale.calculateProportionForLevel (peak);
+        auto const start = getLevelPosition (scale.calculateProportionForLevelDb (zoneStartsDb[i]));
+        auto const end = getLevelPosition (scale.calculateProportionForLevelDb (zoneStartsDb[i + 1]));
 
-        auto const peakHold = getPeakHoldValue (ch);
-        auto const peakHoldProportion = scale.calculateProportionForLevel (peakHold);
+        if (start == end)
+            continue;
 
-        if (ch > 0)
+        auto const colour = getZoneColour (zoneStartsDb[i]);
+        auto const zone = getBarSlice (bounds, std::min (start, end), std::max (start, end));
+
+        g.setGradientFill (
+            isHorizontal ? juce::ColourGradient (colour.darker (0.3f), start, 0.f, colour, end, 0.f, false)
+                         : juce::ColourGradient (colour.darker (0.3f), 0.f, start, colour, 0.f, end, false));
+        g.fillRect (zone);
+    }
+
+    // Cut the bar into segments, leaving a gap of a single pixel at the end of each segment.
+    if (mOptions.segmentSize > 1)
+    {
+        auto const length = isHorizontal ? getWidth() - kOverloadAreaSize : getHeight() - kOverloadAreaSize;
+
+        for (int position = mOptions.segmentSize; position <= length; position += mOptions.segmentSize)
         {
-            isHorizontal ? meterBounds.removeFromTop (barSeparationSpace)
-                         : meterBounds.removeFromLeft (barSeparationSpace);
+            auto const gapStart = isHorizontal ? position - 1 : getHeight() - position;
+            auto const gap = isHorizontal ? juce::Rectangle<int> (gapStart, 0, 1, getHeight())
+                                          : juce::Rectangle<int> (0, gapStart, getWidth(), 1);
+
+            mBarImage.clear ((gap.toFloat() * scaleFactor).getSmallestIntegerContainer());
         }
+    }
 
-        auto barBounds = isHorizontal ? meterBounds.removeFromTop (barSize) : meterBounds.removeFromLeft (barSize);
+    return mBarImage;
+}
 
-        if (isHorizontal)
+void LevelMeterComponent::paint (juce::Graphics& g)
+{
+    auto const isHorizontal = getWidth() > getHeight();
+    auto const bounds = getLocalBounds();
+
+    auto const scaleFactor = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto& barImage = getBarImage (scaleFactor);
+
+    // Draw level bars and peak hold values, skipping bars which are outside the area to repaint.
+    for (int ch = 0; ch < static_cast<int> (mChannelStates.size()); ch++)
+    {
+        auto const barBounds = getBarBounds (ch);
+
+        if (!g.clipRegionIntersects (barBounds.getSmallestIntegerContainer()))
+            continue;
+
+        const auto& state = mChannelStates[static_cast<size_t> (ch)];
+
+        // Invalid samples get a distinct look, so that a blown up signal chain is recognized immediately.
+        auto const showOverloadArea = state.hasNonFiniteSamples || state.isOverloaded || state.hasDenormalSamples;
+        auto const overloadAreaColour = state.hasNonFiniteSamples ? juce::Colours::magenta
+                                        : state.isOverloaded      ? juce::Colours::red
+                                                                  : juce::Colours::orange;
+
+        if (state.hasNonFiniteSamples)
         {
-            if (peakHold >= LevelMeterConstants::kOverloadTriggerLevel)
-            {
-                g.setColour (juce::Colours::red);
-                g.fillRect (barBounds.withLeft (barBounds.getWidth() - kOverloadAreaSize));
-            }
-
-            g.setColour (juce::Colours::darkgreen);
-            g.fillRect (barBounds.withWidth (
-                (meterBounds.getWidth() - static_cast<float> (kOverloadAreaSize)) *
-                static_cast<float> (peakProportion)));
-
-            g.setColour (juce::Colours::darkgreen.brighter());
-            g.drawVerticalLine (
-                juce::roundToInt (
-                    ((meterBounds.getWidth() - static_cast<float> (kOverloadAreaSize)) *
-                     static_cast<float> (peakHoldProportion))),
-                0,
-                barBounds.getBottom());
+            g.setColour (juce::Colours::magenta.withAlpha (0.3f));
+            g.fillRect (barBounds);
         }
-        else
+
+        if (showOverloadArea)
+        {
+            g.setColour (overloadAreaColour);
+            g.fillRect (
+                isHorizontal ? barBounds.withLeft (barBounds.getRight() - static_cast<float> (kOverloadAreaSize))
+                             : barBounds.withBottom (barBounds.getY() + static_cast<float> (kOverloadAreaSize)));
+        }
+
+        auto const levelPosition = getLevelPosition (state.peakProportion);
+        auto const holdPosition = juce::roundToInt (getLevelPosition (state.peakHoldProportion));
+
+        // Copy the lit part of the bar from the pre-rendered image.
+        auto const lit = (isHorizontal ? barBounds.withRight (levelPosition) : barBounds.withTop (levelPosition))
+                             .toNearestInt();
+
+        if (!lit.isEmpty())
         {
-            if (peakHold >= LevelMeterConstants::kOverloadTriggerLevel)
-            {
-                g.setColour (juce::Colours::red);
-                g.fillRect (barBounds.withBottom (kOverloadAreaSize));
-            }
-
-            g.setColour (juce::Colours::darkgreen);
-            g.fillRect (barBounds.withTrimmedTop (
-                meterBounds.getHeight() -
-                (meterBounds.getHeight() - kOverloadAreaSize) * static_cast<float> (peakProportion)));
-
-            g.setColour (juce::Colours::darkgreen.brighter());
-            g.drawHorizontalLine (
-                juce::roundToInt (
-                    meterBounds.getHeight() -
-                    (meterBounds.getHeight() - kOverloadAreaSize) * static_cast<float> (peakHoldProportion)),
-                barBounds.getX(),
-                barBounds.getRight());
+            auto const source = (lit.toFloat() * scaleFactor).toNearestInt();
+            g.drawImage (
+                barImage,
+                lit.getX(),
+                lit.getY(),
+                lit.getWidth(),
+                lit.getHeight(),
+                source.getX(),
+                source.getY(),
+                source.getWidth(),
+                source.getHeight());
         }
+
+        g.setColour (juce::Colours::darkgreen.brighter());
+        if (isHorizontal)
+            g.drawVerticalLine (holdPosition, barBounds.getY(), barBounds.getBottom());
+        else
+            g.drawHorizontalLine (holdPosition, barBounds.getX(), barBounds.getRight());
     }
 
     g.setColour (juce::Colours::black);
@@ -1,13 +1,24 @@
 #pragma once
 
 #include "juce-extensions/audio/metering/LevelMeter.h"
+#include "juce-extensions/audio/metering/TripleBuffer.h"
 
 #include <juce_gui_basics/juce_gui_basics.h>
+#include <vector>
 
 /**
  * Component which shows a level meter with a certain scale.
+ * Channels which received NaN or infinite samples are tinted magenta, channels which received denormal samples show an
+ * orange overload area (unless overloaded). The red overload area shows clipping as detected by the clip detector of
+ * the level meter (see LevelMeter::setClipDetectorOptions()). All of these stay on until clicked or reset.
+ * The component keeps track of what it has drawn per channel, and only repaints the areas which changed: the part of a
+ * bar between its old and new level, and the old and new peak hold lines.
+ * The bars show green, yellow and red zones (see Options), optionally as LED segments. They are rendered into an image
+ * once per size, scale and options change, and every frame only copies the part of the image up to the current level.
+ * The ballistics run on the thread which refreshes the level meter. When that is a LevelMeter::RefreshThread, the
+ * resulting states are handed over to the juce::MessageThread through a TripleBuffer.
  */
-class LevelMeterComponent : public juce::Component, LevelMeter::Subscriber
+class LevelMeterComponent : public juce::Component, LevelMeter::Subscriber, private juce::AsyncUpdater
 {
 public:
     /// The size of the overload area.
@@ -28,12 +39,17 @@ public:
         /// into a single mono channel.
         int maxChannels = kDefaultMaxChannels;
 
+        /// The size of a single LED segment in pixels, including the gap to the next segment. Use 0 for a continuous
+        /// bar.
+        int segmentSize = 0;
+
         /**
          * @returns The default options.
          */
         static Options getDefault();
 
         Options withMaxChannels (int newMaxChannels) const;
+        Options withSegmentSize (int newSegmentSize) const;
     };
 
     /// Expose as public members
@@ -61,32 +77,106 @@ public:
         const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale(),
         const Options& options = Options::getDefault());
 
+    ~LevelMeterComponent() override;
+
     /**
      * Sets options for this meter.
      * @param options The new options to set.
      */
     void setOptions (const Options& options);
 
+    /**
+     * Turns off the overload and invalid sample indicators of all channels.
+     */
+    void resetOverloaded();
+
     // MARK: juce::Component overrides -
     void paint (juce::Graphics& g) override;
+    void resized() override;
+    void mouseDown (const juce::MouseEvent& event) override;
 
 protected:
+    using LevelMeter::Subscriber::catchUpPeak;
     using LevelMeter::Subscriber::getNumChannels;
     using LevelMeter::Subscriber::getPeakHoldValue;
     using LevelMeter::Subscriber::getPeakValue;
     using LevelMeter::Subscriber::getScale;
+    using LevelMeter::Subscriber::hasDenormalSamples;
+    using LevelMeter::Subscriber::hasNonFiniteSamples;
+    using LevelMeter::Subscriber::isOverloaded;
+    using LevelMeter::Subscriber::resetInvalidSamples;
 
 private:
     /// The amount of room left around the meter on the main axis.
     static constexpr int kMargin = 10;
 
+    /**
+     * The state of a channel as drawn by paint().
+     */
+    struct ChannelState
+    {
+        double peakProportion = 0.0;
+        double peakHoldProportion = 0.0;
+        bool hasNonFiniteSamples = false;
+        bool isOverloaded = false;
+        bool hasDenormalSamples = false;
+
+        /**
+         * @return True if the look of the whole bar differs between this state and other.
+         */
+        [[nodiscard]] bool differsInLook (const ChannelState& other) const;
+    };
+
     /// The options for configuring this meter.
     Options mOptions;
 
-    bool mWasSilent { false };
+    /// The state per channel, as (to be) drawn by paint().
+    std::vector<ChannelState> mChannelStates;
+
+    /// The state per channel as calculated by the latest refresh, handed over to the juce::MessageThread.
+    TripleBuffer<std::vector<ChannelState>> mRefreshedChannelStates;
+
+    /// A fully lit bar, covering the whole meter. Rendered by getBarImage() when invalid.
+    juce::Image mBarImage;
+
+    /// The scale factor of mBarImage, in physical pixels per logical pixel.
+    float mBarImageScaleFactor { 1.f };
+
+    /**
+     * @return A fully lit bar for the current size, scale and options, rendering it first if needed.
+     */
+    const juce::Image& getBarImage (float scaleFactor);
+
+    /**
+     * @return The colour of the zone which given level falls in.
+     */
+    [[nodiscard]] juce::Colour getZoneColour (double levelDb) const;
+
+    /**
+     * Repaints the areas of a bar which differ between two states.
+     */
+    void repaintChangedAreas (int channelIndex, const ChannelState& previous, const ChannelState& current);
+
+    /**
+     * @return The bounds of the bar of given channel.
+     */
+    [[nodiscard]] juce::Rectangle<float> getBarBounds (int channelIndex) const;
+
+    /**
+     * @return The position of the edge of a bar filled to given proportion, along the main axis.
+     */
+    [[nodiscard]] float getLevelPosition (double proportion) const;
+
+    /**
+     * @return The part of a bar between two positions along the main axis.
+     */
+    [[nodiscard]] juce::Rectangle<float> getBarSlice (juce::Rectangle<float> barBounds, float start, float end) const;
 
     // MARK: LevelMeter::Subscriber overrides -
     void updateWithMeasurement (const LevelMeter::Measurement& measurement) override;
     void measurementUpdatesFinished() override;
     void levelMeterPrepared (int numChannels) override;
+
+    // MARK: juce::AsyncUpdater overrides -
+    void handleAsyncUpdate() override;
 };
@@ -0,0 +1,108 @@
+#include "LevelMeterHistoryComponent.h"
+
+LevelMeterHistoryComponent::LevelMeterHistoryComponent (LevelMeter& levelMeter, const LevelMeter::Scale& scale) :
+    Subscriber (scale),
+    mHistory (levelMeter.getHistory())
+{
+    subscribeToLevelMeter (levelMeter);
+}
+
+LevelMeterHistoryComponent::~LevelMeterHistoryComponent()
+{
+    unsubscribeFromLevelMeter();
+    cancelPendingUpdate();
+}
+
+void LevelMeterHistoryComponent::setVisibleDurationSeconds (double const seconds)
+{
+    jassert (seconds > 0.0);
+
+    {
+        const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+        mVisibleDurationSeconds = seconds;
+    }
+
+    repaint();
+}
+
+void LevelMeterHistoryComponent::paint (juce::Graphics& g)
+{
+    // The history is updated by the thread which refreshes the level meter.
+    const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+
+    auto const bounds = getLocalBounds();
+    auto const numChannels = mHistory.getNumChannels();
+
+    if (numChannels > 0 && getWidth() > 0)
+    {
+        auto const& scale = getScale();
+        auto const secondsPerPixel = mVisibleDurationSeconds / getWidth();
+        auto const laneHeight = static_cast<float> (bounds.getHeight()) / static_cast<float> (numChannels);
+
+        // Only render the columns which need repainting.
+        auto const clip = g.getClipBounds().getIntersection (bounds);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto const laneTop = static_cast<float> (ch) * laneHeight;
+            auto const laneBottom = laneTop + laneHeight;
+
+            if (laneBottom < static_cast<float> (clip.getY()) || laneTop > static_cast<float> (clip.getBottom()))
+                continue;
+
+            for (int x = clip.getX(); x < clip.getRight(); ++x)
+            {
+                auto const startSecondsAgo = (getWidth() - x) * secondsPerPixel;
+                auto const endSecondsAgo = startSecondsAgo - secondsPerPixel;
+
+                auto const maxProportion = static_cast<float> (
+                    scale.calculateProportionForLevel (mHistory.getMaxLevel (ch, startSecondsAgo, endSecondsAgo)));
+                auto const rmsProportion = static_cast<float> (scale.calculateProportionForLevel (
+                    mHistory.getFrameAt (ch, endSecondsAgo + secondsPerPixel * 0.5).rmsLevel));
+
+                g.setColour (juce::Colours::darkgreen);
+                g.drawVerticalLine (x, laneBottom - laneHeight * maxProportion, laneBottom);
+
+                g.setColour (juce::Colours::darkgreen.brighter());
+                g.drawVerticalLine (x, laneBottom - laneHeight * rmsProportion, laneBottom);
+            }
+        }
+    }
+
+    g.setColour (juce::Colours::black);
+    g.drawRect (bounds);
+}
+
+void LevelMeterHistoryComponent::measurementUpdatesFinished()
+{
+    if (!mHistory.isEnabled())
+        return;
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        repaint();
+    else
+        triggerAsyncUpdate();
+}
+
+void LevelMeterHistoryComponent::handleAsyncUpdate()
+{
+    repaint();
+}
+
+bool LevelMeterHistoryComponent::hasSettled() const
+{
+    // The history only moves with new measurements, and silent ones change nothing while only silence is visible.
+    for (int ch = 0; ch < mHistory.getNumChannels(); ++ch)
+    {
+        if (mHistory.getMaxLevel (ch, mVisibleDurationSeconds, 0.0) > 0.f)
+            return false;
+    }
+
+    return true;
+}
+
+void LevelMeterHistoryComponent::levelMeterPrepared ([[maybe_unused]] int numChannels)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+    repaint();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * Component which shows the level history of a level meter, with the newest levels on the right. Only the visible
+ * range of history is rendered, at pixel resolution.
+ */
+class LevelMeterHistoryComponent : public juce::Component, LevelMeter::Subscriber, private juce::AsyncUpdater
+{
+public:
+    /// The default amount of history to show.
+    static constexpr double kDefaultVisibleDurationSeconds = 60.0;
+
+    /**
+     * Constructor.
+     * @param levelMeter The level meter to show the history of. History must be enabled using
+     * LevelMeter::setHistoryOptions().
+     * @param scale The scale to use.
+     */
+    explicit LevelMeterHistoryComponent (
+        LevelMeter& levelMeter,
+        const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale());
+
+    ~LevelMeterHistoryComponent() override;
+
+    /**
+     * Sets the amount of history to show.
+     * @param seconds The duration of the visible range, in seconds.
+     */
+    void setVisibleDurationSeconds (double seconds);
+
+    // MARK: juce::Component overrides -
+    void paint (juce::Graphics& g) override;
+
+private:
+    const LevelMeterHistory& mHistory;
+    double mVisibleDurationSeconds { kDefaultVisibleDurationSeconds };
+
+    // MARK: LevelMeter::Subscriber overrides -
+    void measurementUpdatesFinished() override;
+    bool hasSettled() const override;
+
+    // MARK: juce::AsyncUpdater overrides -
+    void handleAsyncUpdate() override;
+    void levelMeterPrepared (int numChannels) override;
+};
@@ -0,0 +1,14 @@
+#include "LevelMeterVBlankDriver.h"
+
+LevelMeterVBlankDriver::LevelMeterVBlankDriver (juce::Component& component, int const divisor) :
+    mRefreshDriver (divisor),
+    mVBlankAttachment (&component, [this] {
+        mRefreshDriver.refresh();
+    })
+{
+}
+
+void LevelMeterVBlankDriver::setDivisor (int const divisor)
+{
+    mRefreshDriver.setDivisor (divisor);
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * Refreshes all level meters in sync with the vertical blank of the display which shows given component, instead of
+ * with the shared 30 Hz timer. This avoids judder on 60, 120 or 144 Hz displays. Use a divisor to refresh at a fraction
+ * of the display rate. The component must be on screen for the refresh to happen, so attach it to the main window (or
+ * another component which is always showing).
+ */
+class LevelMeterVBlankDriver
+{
+public:
+    /**
+     * Constructor.
+     * @param component The component whose display to sync with.
+     * @param divisor Only refresh on every divisor-th vertical blank.
+     */
+    explicit LevelMeterVBlankDriver (juce::Component& component, int divisor = 1);
+
+    JUCE_DECLARE_NON_COPYABLE (LevelMeterVBlankDriver)
+    JUCE_DECLARE_NON_MOVEABLE (LevelMeterVBlankDriver)
+
+    /**
+     * Sets the divisor.
+     * @param divisor Only refresh on every divisor-th vertical blank.
+     */
+    void setDivisor (int divisor);
+
+private:
+    LevelMeter::RefreshDriver mRefreshDriver;
+    juce::VBlankAttachment mVBlankAttachment;
+};
@@ -0,0 +1,365 @@
+#include "MeterBridgeComponent.h"
+
+#include "juce-extensions/audio/metering/FastDecibels.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+/**
+ * Subscription to a single level meter, which forwards all measurements into the shared channel state of the bridge.
+ * Channels are never folded into a single mono channel, and the channel data of the Subscriber base class is not used.
+ */
+class MeterBridgeComponent::MeterLink : public LevelMeter::Subscriber
+{
+public:
+    MeterLink (MeterBridgeComponent& bridge, LevelMeter& levelMeter) :
+        Subscriber (bridge.mScale, std::numeric_limits<int>::max()),
+        mBridge (bridge),
+        mLevelMeter (levelMeter)
+    {
+    }
+
+    ~MeterLink() override
+    {
+        unsubscribeFromLevelMeter();
+    }
+
+    void subscribe()
+    {
+        subscribeToLevelMeter (mLevelMeter);
+    }
+
+    [[nodiscard]] LevelMeter& getLevelMeter() const
+    {
+        return mLevelMeter;
+    }
+
+    [[nodiscard]] int getNumChannels() const
+    {
+        return mNumChannels;
+    }
+
+    void setFirstChannel (int firstChannel)
+    {
+        mFirstChannel = firstChannel;
+    }
+
+    void updateWithMeasurement (const LevelMeter::Measurement& measurement) override
+    {
+        if (!juce::isPositiveAndBelow (measurement.channelIndex, mNumChannels))
+            return;
+
+        mHasActivity = mHasActivity || measurement.peakLevel > 0.0 || measurement.overloaded;
+        mBridge.addMeasurement (mFirstChannel + measurement.channelIndex, measurement);
+    }
+
+    void updateWithMeasurements (const LevelMeter::Measurement* measurements, int const numMeasurements) override
+    {
+        for (int i = 0; i < numMeasurements; ++i)
+            MeterLink::updateWithMeasurement (measurements[i]);
+    }
+
+    void measurementUpdatesFinished() override
+    {
+        mBridge.scheduleRepaint (std::exchange (mHasActivity, false));
+    }
+
+    bool hasSettled() const override
+    {
+        // The bridge runs the ballistics itself, so it has settled once it painted everything at minus infinity.
+        return mBridge.mIsSilent && !mBridge.mRepaintPending;
+    }
+
+private:
+    MeterBridgeComponent& mBridge;
+    LevelMeter& mLevelMeter;
+    int mFirstChannel { 0 };
+    int mNumChannels { 0 };
+    bool mHasActivity { false };
+
+    void levelMeterPrepared (int numChannels) override
+    {
+        mNumChannels = numChannels;
+        mBridge.updateChannelLayout();
+    }
+};
+
+MeterBridgeComponent::Options MeterBridgeComponent::Options::getDefault()
+{
+    return {};
+}
+
+MeterBridgeComponent::MeterBridgeComponent (const LevelMeter::Scale& scale, const Options& options) :
+    mScale (scale),
+    mOptions (options)
+{
+}
+
+MeterBridgeComponent::~MeterBridgeComponent()
+{
+    {
+        const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+        mLinks.clear();
+    }
+
+    cancelPendingUpdate();
+}
+
+void MeterBridgeComponent::addLevelMeter (LevelMeter& levelMeter)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    // The links are iterated by updateChannelLayout(), which runs on any thread which prepares a level meter.
+    const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+
+    // Add the link before subscribing, because subscribing prepares it, which updates the layout.
+    mLinks.push_back (std::make_unique<MeterLink> (*this, levelMeter));
+    mLinks.back()->subscribe();
+}
+
+void MeterBridgeComponent::removeLevelMeter (LevelMeter& levelMeter)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+    mLinks.erase (
+        std::remove_if (
+            mLinks.begin(),
+            mLinks.end(),
+            [&levelMeter] (const auto& link) {
+                return &link->getLevelMeter() == &levelMeter;
+            }),
+        mLinks.end());
+
+    updateChannelLayout();
+}
+
+void MeterBridgeComponent::clearLevelMeters()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+    mLinks.clear();
+    updateChannelLayout();
+}
+
+int MeterBridgeComponent::getNumChannels() const
+{
+    return static_cast<int> (mChannels.size());
+}
+
+void MeterBridgeComponent::setOptions (const Options& options)
+{
+    mOptions = options;
+    repaint();
+}
+
+void MeterBridgeComponent::resetOverloaded()
+{
+    const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+
+    for (auto& channel : mChannels)
+        channel.overloaded = false;
+
+    repaint();
+}
+
+void MeterBridgeComponent::updateChannelLayout()
+{
+    const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+
+    int numChannels = 0;
+    for (auto& link : mLinks)
+    {
+        link->setFirstChannel (numChannels);
+        numChannels += link->getNumChannels();
+    }
+
+    mChannels.resize (static_cast<size_t> (numChannels));
+
+    for (auto& channel : mChannels)
+    {
+        channel.peakLevel.reset();
+        channel.peakLevel.setMinusInfinityDb (mScale.getMinusInfinityDb());
+        channel.peakLevel.setPeakHoldTime (1000 / LevelMeterConstants::kRefreshRateHz);
+        channel.peakHoldLevel.reset();
+        channel.peakHoldLevel.setMinusInfinityDb (mScale.getMinusInfinityDb());
+        channel.peakHoldLevel.setPeakHoldTime (LevelMeterConstants::kPeakHoldDefaultValueTimeMs);
+        channel.overloaded = false;
+    }
+
+    mIsSilent = false;
+    repaint();
+}
+
+void MeterBridgeComponent::addMeasurement (int const channelIndex, const LevelMeter::Measurement& measurement)
+{
+    auto& channel = mChannels[static_cast<size_t> (channelIndex)];
+    channel.peakLevel.updateLevel (measurement.peakLevel);
+    channel.peakHoldLevel.updateLevel (measurement.peakLevel);
+
+    if (measurement.overloaded)
+        channel.overloaded = true;
+}
+
+void MeterBridgeComponent::scheduleRepaint (bool const hasActivity)
+{
+    if (mRepaintPending || (mIsSilent && !hasActivity))
+        return;
+
+    mRepaintPending = true;
+
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        repaint();
+    else
+        triggerAsyncUpdate();
+}
+
+void MeterBridgeComponent::handleAsyncUpdate()
+{
+    repaint();
+}
+
+void MeterBridgeComponent::paint (juce::Graphics& g)
+{
+    // The channel states are updated by the thread which refreshes the level meters, so only copy the levels while
+    // holding the processing lock, and map and draw them after releasing it.
+    {
+        const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+
+        mRepaintPending = false;
+
+        auto const numChannels = mChannels.size();
+        mPeakProportions.resize (numChannels);
+        mPeakHoldProportions.resize (numChannels);
+        mOverloadedChannels.resize (numChannels);
+        mDeclines.resize (numChannels * 2);
+
+        // Advance the ballistics of all channels, converting their declines to gains in a single batch.
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            mDeclines[ch] = static_cast<float> (mChannels[ch].peakLevel.advanceTime());
+            mDeclines[numChannels + ch] = static_cast<float> (mChannels[ch].peakHoldLevel.advanceTime());
+        }
+
+        FastDecibels::decibelsToGains (
+            mDeclines.data(),
+            mDeclines.data(),
+            static_cast<int> (mDeclines.size()),
+            static_cast<float> (mScale.getMinusInfinityDb()));
+
+        for (size_t ch = 0; ch < numChannels; ++ch)
+        {
+            mPeakProportions[ch] = mChannels[ch].peakLevel.getNextLevel (mDeclines[ch]);
+            mPeakHoldProportions[ch] = mChannels[ch].peakHoldLevel.getNextLevel (mDeclines[numChannels + ch]);
+            mOverloadedChannels[ch] = mChannels[ch].overloaded;
+        }
+    }
+
+    auto const bounds = getLocalBounds();
+    auto const numChannels = static_cast<int> (mPeakProportions.size());
+
+    if (numChannels == 0)
+    {
+        g.setColour (juce::Colours::black);
+        g.drawRect (bounds);
+        return;
+    }
+
+    // Map all levels in one pass.
+    mScale.calculateProportionsForLevels (mPeakProportions.data(), mPeakProportions.data(), numChannels);
+    mScale.calculateProportionsForLevels (mPeakHoldProportions.data(), mPeakHoldProportions.data(), numChannels);
+
+    auto const isHorizontal = getWidth() > getHeight();
+    auto const overloadAreaSize = static_cast<float> (kOverloadAreaSize);
+    auto const length = static_cast<float> (isHorizontal ? getWidth() : getHeight()) - overloadAreaSize;
+    auto const totalSize = static_cast<float> (isHorizontal ? getHeight() : getWidth());
+    auto const separation = mOptions.barSeparationSpace;
+    auto const barSize =
+        (totalSize - separation * static_cast<float> (numChannels - 1)) / static_cast<float> (numChannels);
+
+    auto const yellowStart = mScale.calculateProportionForLevelDb (mOptions.yellowStartPointDb);
+    auto const redStart = mScale.calculateProportionForLevelDb (mOptions.overloadStartPointDb);
+
+    // Returns the part of a bar between two positions along the main axis, in pixels from the start of the meter.
+    auto const getBarPart = [isHorizontal, totalLength = length + overloadAreaSize, barSize] (
+                                float barStart, float start, float end) {
+        return isHorizontal ? juce::Rectangle<float> (start, barStart, end - start, barSize)
+                            : juce::Rectangle<float> (barStart, totalLength - end, barSize, end - start);
+    };
+
+    mGreenRectangles.clear();
+    mYellowRectangles.clear();
+    mRedRectangles.clear();
+    mPeakHoldRectangles.clear();
+
+    mGreenRectangles.ensureStorageAllocated (numChannels);
+    mYellowRectangles.ensureStorageAllocated (numChannels);
+    mRedRectangles.ensureStorageAllocated (numChannels * 2);
+    mPeakHoldRectangles.ensureStorageAllocated (numChannels);
+
+    bool isSilent = true;
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto const peak = mPeakProportions[static_cast<size_t> (ch)];
+        auto const peakHold = mPeakHoldProportions[static_cast<size_t> (ch)];
+        auto const overloaded = mOverloadedChannels[static_cast<size_t> (ch)];
+        auto const barStart = static_cast<float> (ch) * (barSize + separation);
+
+        if (peak > 0.0)
+        {
+            mGreenRectangles.addWithoutMerging (
+                getBarPart (barStart, 0.f, length * static_cast<float> (std::min (peak, yellowStart))));
+        }
+
+        if (peak > yellowStart)
+        {
+            mYellowRectangles.addWithoutMerging (getBarPart (
+                barStart,
+                length * static_cast<float> (yellowStart),
+                length * static_cast<float> (std::min (peak, redStart))));
+        }
+
+        if (peak > redStart)
+        {
+            mRedRectangles.addWithoutMerging (getBarPart (
+                barStart,
+                length * static_cast<float> (redStart),
+                length * static_cast<float> (peak)));
+        }
+
+        if (peakHold > 0.0)
+        {
+            auto const holdPosition = std::floor (length * static_cast<float> (peakHold));
+            mPeakHoldRectangles.addWithoutMerging (getBarPart (barStart, holdPosition - 1.f, holdPosition));
+        }
+
+        if (overloaded)
+            mRedRectangles.addWithoutMerging (getBarPart (barStart, length, length + overloadAreaSize));
+
+        isSilent = isSilent && peak <= 0.0 && peakHold <= 0.0 && !overloaded;
+    }
+
+    {
+        // Read by the links from the thread which refreshes the level meters.
+        const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+        mIsSilent = isSilent;
+    }
+
+    g.setColour (juce::Colours::darkgreen);
+    g.fillRectList (mGreenRectangles);
+
+    g.setColour (juce::Colours::gold);
+    g.fillRectList (mYellowRectangles);
+
+    g.setColour (juce::Colours::red);
+    g.fillRectList (mRedRectangles);
+
+    g.setColour (juce::Colours::darkgreen.brighter());
+    g.fillRectList (mPeakHoldRectangles);
+
+    g.setColour (juce::Colours::black);
+    g.drawRect (bounds);
+}
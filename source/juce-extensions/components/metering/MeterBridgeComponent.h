@@ -0,0 +1,151 @@
+#pragma once
+
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
+#include <memory>
+#include <vector>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * Component which shows the channels of many level meters as a single row of bars, for example as an overview of all
+ * channels of a mixer. Unlike a LevelMeterComponent per meter, the bridge keeps the ballistics of all channels in a
+ * single array and draws all bars in a single paint() call, batching the rectangles of each colour into a single
+ * juce::RectangleList fill.
+ * Measurements are added to the ballistics from the thread which refreshes the level meters. paint() advances them and
+ * copies the levels while holding the processing lock of LevelMeter, and maps and draws them after releasing it.
+ */
+class MeterBridgeComponent : public juce::Component, private juce::AsyncUpdater
+{
+public:
+    /**
+     * Options to configure the behaviour of this bridge.
+     */
+    struct Options
+    {
+        /// The start point of yellow.
+        double yellowStartPointDb = -12.0;
+
+        /// The start point of overload (red).
+        double overloadStartPointDb = -1.0;
+
+        /// The space between bars in pixels.
+        float barSeparationSpace = 1.f;
+
+        /**
+         * @returns The default options.
+         */
+        static Options getDefault();
+    };
+
+    /// The size of the overload area.
+    static constexpr int kOverloadAreaSize = 4;
+
+    /**
+     * Constructor.
+     * @param scale Scale to use.
+     * @param options The bridge options.
+     */
+    explicit MeterBridgeComponent (
+        const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale(),
+        const Options& options = Options::getDefault());
+
+    ~MeterBridgeComponent() override;
+
+    /**
+     * Adds the channels of a level meter to the end of this bridge.
+     * @param levelMeter The level meter to show.
+     */
+    void addLevelMeter (LevelMeter& levelMeter);
+
+    /**
+     * Removes the channels of a level meter from this bridge.
+     * @param levelMeter The level meter to remove.
+     */
+    void removeLevelMeter (LevelMeter& levelMeter);
+
+    /**
+     * Removes all level meters from this bridge.
+     */
+    void clearLevelMeters();
+
+    /**
+     * @return The total number of channels of all level meters.
+     */
+    [[nodiscard]] int getNumChannels() const;
+
+    /**
+     * Sets options for this bridge.
+     * @param options The new options to set.
+     */
+    void setOptions (const Options& options);
+
+    /**
+     * Turns off the overloaded flag of all channels.
+     */
+    void resetOverloaded();
+
+    // MARK: juce::Component overrides -
+    void paint (juce::Graphics& g) override;
+
+private:
+    class MeterLink;
+
+    /**
+     * The ballistics of a single channel.
+     */
+    struct ChannelState
+    {
+        LevelPeakValue<double> peakLevel;
+        LevelPeakValue<double> peakHoldLevel;
+        bool overloaded = false;
+    };
+
+    const LevelMeter::Scale& mScale;
+    Options mOptions;
+
+    /// A subscription per level meter, in the order in which the channels are shown.
+    std::vector<std::unique_ptr<MeterLink>> mLinks;
+
+    /// The ballistics of all channels of all meters.
+    std::vector<ChannelState> mChannels;
+
+    /// Scratch buffers for mapping all levels to proportions in one pass. Only accessed from paint().
+    std::vector<double> mPeakProportions;
+    std::vector<double> mPeakHoldProportions;
+    std::vector<bool> mOverloadedChannels;
+
+    /// The declines of the peak levels followed by those of the peak hold levels, converted to gains in one batch.
+    /// Float is precise enough for the decline of a single frame. Only accessed from paint().
+    std::vector<float> mDeclines;
+
+    /// Rectangles per colour, kept as members so their storage is reused between frames. Only accessed from paint().
+    juce::RectangleList<float> mGreenRectangles;
+    juce::RectangleList<float> mYellowRectangles;
+    juce::RectangleList<float> mRedRectangles;
+    juce::RectangleList<float> mPeakHoldRectangles;
+
+    /// True if a repaint was requested which didn't happen yet, to request it only once per refresh.
+    bool mRepaintPending { false };
+
+    /// True if the previous paint() showed all channels at minus infinity.
+    bool mIsSilent { false };
+
+    /**
+     * Assigns every meter its range of channels and prepares the ballistics for all channels.
+     */
+    void updateChannelLayout();
+
+    /**
+     * Updates the ballistics of a channel with a measurement.
+     */
+    void addMeasurement (int channelIndex, const LevelMeter::Measurement& measurement);
+
+    /**
+     * Requests a repaint, unless nothing changed since the previous one.
+     */
+    void scheduleRepaint (bool hasActivity);
+
+    // MARK: juce::AsyncUpdater overrides -
+    void handleAsyncUpdate() override;
+};
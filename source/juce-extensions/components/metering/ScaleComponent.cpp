@@ -1,55 +1,94 @@
 #include "ScaleComponent.h"
 #include "LevelMeterComponent.h"
 
+ScaleComponent::ScaleComponent (const LevelMeter::Scale& scale, bool const renderToImage) : mScale (scale)
+{
+    setBufferedToImage (renderToImage);
+}
+
 void ScaleComponent::paint (juce::Graphics& g)
 {
-    auto b = getLocalBounds().toFloat();
-    bool isHorizontal = getWidth() > getHeight();
+    auto const b = getLocalBounds().toFloat();
+
+    for (auto const position : mLinePositions)
+    {
+        if (mIsHorizontal)
+            g.drawVerticalLine (position, b.getY(), b.getY() + kScaleLineLength);
+        else
+            g.drawHorizontalLine (position, b.getX(), b.getX() + kScaleLineLength);
+    }
+
+    mLabels.draw (g);
+}
+
+void ScaleComponent::resized()
+{
+    updateLayout();
+}
 
+void ScaleComponent::updateLayout()
+{
+    auto const b = getLocalBounds().toFloat();
     const auto& divisions = mScale.getDivisions();
 
-    const auto scaleLineLength = 6.f;
-    for (auto division = divisions.begin(); division != divisions.end(); ++division)
+    mIsHorizontal = getWidth() > getHeight();
+    mLinePositions.clear();
+    mLabels.clear();
+
+    const auto scaleNumberWidth = 30.f;
+    const auto scaleNumberHeight = 20.f;
+    const auto labelSpacing = 2.f;
+    juce::Font const font;
+
+    // Lay out from the highest division down, so that the labels of the highest divisions win when labels overlap.
+    juce::Rectangle<float> previousLabelBounds;
+
+    for (auto i = static_cast<int> (divisions.size()) - 1; i > 0; --i)
     {
-        const auto scaleNumberWidth = 30;
+        auto const division = divisions[static_cast<size_t> (i)];
+        auto const proportion = static_cast<float> (mScale.calculateProportionForLevelDb (division));
 
-        bool isFirst = division == divisions.begin();
+        juce::GlyphArrangement label;
+        int position;
 
-        if (isHorizontal)
+        if (mIsHorizontal)
         {
-            auto xPos = b.getX() + (b.getWidth() - LevelMeterComponent::kOverloadAreaSize) *
-                                       mScale.calculateProportionForLevelDb (*division);
-
-            if (!isFirst)
-            {
-                g.drawVerticalLine (juce::roundToInt (xPos), 0.f, scaleLineLength);
-                g.drawText (
-                    juce::String (*division),
-                    juce::roundToInt (xPos) - scaleNumberWidth / 2,
-                    juce::roundToInt (scaleLineLength),
-                    scaleNumberWidth,
-                    juce::roundToInt (b.getHeight()),
-                    juce::Justification::centredTop);
-            }
+            auto const xPos = b.getX() + (b.getWidth() - LevelMeterComponent::kOverloadAreaSize) * proportion;
+            position = juce::roundToInt (xPos);
+
+            label.addFittedText (
+                font,
+                juce::String (division),
+                static_cast<float> (position) - scaleNumberWidth / 2,
+                kScaleLineLength,
+                scaleNumberWidth,
+                b.getHeight() - kScaleLineLength,
+                juce::Justification::centredTop,
+                1);
         }
         else
         {
-            const auto scaleNumberHeight = 20;
-
-            auto yPos = b.getBottom() - (b.getHeight() - LevelMeterComponent::kOverloadAreaSize) *
-                                            mScale.calculateProportionForLevelDb (*division);
-
-            if (!isFirst)
-            {
-                g.drawHorizontalLine (juce::roundToInt (yPos), 0.f, scaleLineLength);
-                g.drawText (
-                    juce::String (*division),
-                    juce::roundToInt (scaleLineLength),
-                    juce::roundToInt (yPos) - scaleNumberHeight / 2,
-                    scaleNumberWidth,
-                    scaleNumberHeight,
-                    juce::Justification::centred);
-            }
+            auto const yPos = b.getBottom() - (b.getHeight() - LevelMeterComponent::kOverloadAreaSize) * proportion;
+            position = juce::roundToInt (yPos);
+
+            label.addFittedText (
+                font,
+                juce::String (division),
+                kScaleLineLength,
+                static_cast<float> (position) - scaleNumberHeight / 2,
+                scaleNumberWidth,
+                scaleNumberHeight,
+                juce::Justification::centred,
+                1);
+        }
+
+        mLinePositions.push_back (position);
+
+        auto const labelBounds = label.getBoundingBox (0, -1, true).expanded (labelSpacing);
+        if (label.getNumGlyphs() > 0 && !labelBounds.intersects (previousLabelBounds))
+        {
+            mLabels.addGlyphArrangement (label);
+            previousLabelBounds = labelBounds;
         }
     }
 }
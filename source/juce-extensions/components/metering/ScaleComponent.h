@@ -2,17 +2,46 @@
 
 #include <juce-extensions/audio/metering/LevelMeter.h>
 #include <juce_gui_basics/juce_gui_basics.h>
+#include <vector>
 
 /**
  * Class which displays a scale.
+ * The positions of the divisions and the glyphs of the labels are laid out once per resize, dropping labels which would
+ * overlap a label of a higher division. By default the scale is also buffered to an image, so repaints triggered by
+ * neighbouring meters cost a single blit.
  */
 class ScaleComponent : public juce::Component
 {
 public:
-    explicit ScaleComponent (const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale()) : mScale (scale) {}
+    /**
+     * Constructor.
+     * @param scale The scale to display.
+     * @param renderToImage True to buffer the scale to an image, see juce::Component::setBufferedToImage().
+     */
+    explicit ScaleComponent (
+        const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale(),
+        bool renderToImage = true);
 
     void paint (juce::Graphics& g) override;
+    void resized() override;
 
 private:
+    /// The length of the line of a division.
+    static constexpr float kScaleLineLength = 6.f;
+
     const LevelMeter::Scale& mScale;
+
+    /// The positions of the lines of all divisions (except the first), along the main axis.
+    std::vector<int> mLinePositions;
+
+    /// The glyphs of all labels which fit without overlapping.
+    juce::GlyphArrangement mLabels;
+
+    /// True if the layout was made for a horizontal scale.
+    bool mIsHorizontal { false };
+
+    /**
+     * Lays out the divisions and labels for the current size.
+     */
+    void updateLayout();
 };
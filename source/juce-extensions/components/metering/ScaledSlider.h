@@ -1,5 +1,8 @@
 #pragma once
 
+#include "juce-extensions/audio/metering/FixedScale.h"
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
 #include <juce_gui_basics/juce_gui_basics.h>
 
 /**
@@ -49,3 +52,25 @@ public:
 private:
     const LevelMeter::Scale& mScale { LevelMeter::Scale::getDefaultScale() };
 };
+
+/**
+ * A customized slider which applies a scale known at compile time. The mapping functions of the FixedScale are called
+ * directly, so the compiler can inline them.
+ * @tparam FixedScaleType The FixedScale to apply, for example DefaultFixedScale.
+ */
+template <class FixedScaleType>
+class FixedScaledSlider : public juce::Slider
+{
+public:
+    using juce::Slider::Slider;
+
+    double proportionOfLengthToValue (double proportion) override
+    {
+        return FixedScaleType::calculateLevelDbForProportion (proportion);
+    }
+
+    double valueToProportionOfLength (double value) override
+    {
+        return FixedScaleType::calculateProportionForLevelDb (value);
+    }
+};
@@ -0,0 +1,256 @@
+#include "VirtualMeterListComponent.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * Subscription to a level meter which only remembers, per channel, the peak which would currently determine the peak
+ * hold value. This is all that is needed to catch up when the strip of the meter scrolls into view.
+ */
+class VirtualMeterListComponent::PeakAccumulator : public LevelMeter::Subscriber
+{
+public:
+    PeakAccumulator (const LevelMeter::Scale& scale, LevelMeter& levelMeter) :
+        Subscriber (scale, std::numeric_limits<int>::max()),
+        mLevelMeter (levelMeter)
+    {
+        subscribeToLevelMeter (levelMeter);
+    }
+
+    ~PeakAccumulator() override
+    {
+        unsubscribeFromLevelMeter();
+    }
+
+    [[nodiscard]] LevelMeter& getLevelMeter() const
+    {
+        return mLevelMeter;
+    }
+
+    /**
+     * Calls given function with the channel index, level and age of the remembered peak of every channel.
+     */
+    template <typename Function>
+    void forEachPeak (Function&& function) const
+    {
+        auto const now = juce::Time::getMillisecondCounter();
+
+        for (size_t ch = 0; ch < mPeaks.size(); ++ch)
+        {
+            if (mPeaks[ch].level > 0.0)
+                function (static_cast<int> (ch), mPeaks[ch].level, now - mPeaks[ch].timeMs);
+        }
+    }
+
+    void updateWithMeasurement (const LevelMeter::Measurement& measurement) override
+    {
+        if (!juce::isPositiveAndBelow (measurement.channelIndex, static_cast<int> (mPeaks.size())))
+            return;
+
+        auto& peak = mPeaks[static_cast<size_t> (measurement.channelIndex)];
+        auto const now = juce::Time::getMillisecondCounter();
+
+        // A lower level only takes over once the remembered peak has decayed below it, with the same ballistics as the
+        // peak hold value of a strip.
+        if (measurement.peakLevel >= peak.level
+            || getCaughtUpPeakHoldValue (measurement.channelIndex, peak.level, now - peak.timeMs)
+                   <= measurement.peakLevel)
+            peak = { measurement.peakLevel, now };
+    }
+
+    void updateWithMeasurements (const LevelMeter::Measurement* measurements, int const numMeasurements) override
+    {
+        for (int i = 0; i < numMeasurements; ++i)
+            PeakAccumulator::updateWithMeasurement (measurements[i]);
+    }
+
+private:
+    struct Peak
+    {
+        double level = 0.0;
+        uint32_t timeMs = 0;
+    };
+
+    LevelMeter& mLevelMeter;
+    std::vector<Peak> mPeaks;
+
+    void levelMeterPrepared (int numChannels) override
+    {
+        mPeaks.assign (static_cast<size_t> (numChannels), {});
+    }
+};
+
+/**
+ * A LevelMeterComponent which can be assigned to any of the strips of the list.
+ */
+class VirtualMeterListComponent::Strip : public LevelMeterComponent
+{
+public:
+    static constexpr int kUnassigned = -1;
+
+    using LevelMeterComponent::LevelMeterComponent;
+
+    [[nodiscard]] int getStripIndex() const
+    {
+        return mStripIndex;
+    }
+
+    /**
+     * Shows the strip with given index, catching up with the peaks which happened while it wasn't visible.
+     */
+    void assign (int stripIndex, const PeakAccumulator& accumulator)
+    {
+        mStripIndex = stripIndex;
+        subscribeToLevelMeter (accumulator.getLevelMeter());
+
+        // The accumulator and this strip might be refreshed by a refresh thread.
+        const juce::ScopedLock lock (LevelMeter::getProcessingLock());
+        accumulator.forEachPeak ([this] (int channelIndex, double level, uint32_t ageMs) {
+            catchUpPeak (channelIndex, level, ageMs);
+        });
+
+        setVisible (true);
+    }
+
+    /**
+     * Stops showing a strip, after which this component can be assigned to another strip.
+     */
+    void unassign()
+    {
+        mStripIndex = kUnassigned;
+        unsubscribeFromLevelMeter();
+        setVisible (false);
+    }
+
+private:
+    int mStripIndex { kUnassigned };
+};
+
+VirtualMeterListComponent::VirtualMeterListComponent (
+    const LevelMeter::Scale& scale,
+    const LevelMeterComponent::Options& options) :
+    mScale (scale),
+    mOptions (options)
+{
+    setViewedComponent (&mContent, false);
+    setScrollBarsShown (false, true);
+}
+
+VirtualMeterListComponent::~VirtualMeterListComponent()
+{
+    setViewedComponent (nullptr, false);
+    mStrips.clear();
+    mAccumulators.clear();
+}
+
+void VirtualMeterListComponent::addLevelMeter (LevelMeter& levelMeter)
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    mAccumulators.push_back (std::make_unique<PeakAccumulator> (mScale, levelMeter));
+    updateContentSize();
+}
+
+void VirtualMeterListComponent::clearLevelMeters()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    for (auto& strip : mStrips)
+        strip->unassign();
+
+    mAccumulators.clear();
+    updateContentSize();
+}
+
+int VirtualMeterListComponent::getNumStrips() const
+{
+    return static_cast<int> (mAccumulators.size());
+}
+
+int VirtualMeterListComponent::getNumVisibleStrips() const
+{
+    return static_cast<int> (std::count_if (mStrips.begin(), mStrips.end(), [] (const auto& strip) {
+        return strip->getStripIndex() != Strip::kUnassigned;
+    }));
+}
+
+void VirtualMeterListComponent::setStripWidth (int const stripWidth)
+{
+    jassert (stripWidth > 0);
+    mStripWidth = std::max (1, stripWidth);
+
+    // All positions change, so start over.
+    for (auto& strip : mStrips)
+        strip->unassign();
+
+    updateContentSize();
+}
+
+void VirtualMeterListComponent::resized()
+{
+    juce::Viewport::resized();
+    updateContentSize();
+}
+
+void VirtualMeterListComponent::visibleAreaChanged ([[maybe_unused]] const juce::Rectangle<int>& newVisibleArea)
+{
+    updateVisibleStrips();
+}
+
+void VirtualMeterListComponent::updateContentSize()
+{
+    mContent.setSize (getNumStrips() * mStripWidth, getMaximumVisibleHeight());
+    updateVisibleStrips();
+}
+
+void VirtualMeterListComponent::updateVisibleStrips()
+{
+    auto const viewArea = getViewArea();
+    auto const numStrips = getNumStrips();
+    auto const firstVisible = juce::jlimit (0, numStrips, viewArea.getX() / mStripWidth);
+    auto const endVisible = juce::jlimit (0, numStrips, (viewArea.getRight() + mStripWidth - 1) / mStripWidth);
+
+    // Return strips which are no longer visible to the pool.
+    std::vector<Strip*> free;
+    std::vector<bool> isAssigned (static_cast<size_t> (endVisible - firstVisible), false);
+
+    for (auto& strip : mStrips)
+    {
+        auto const index = strip->getStripIndex();
+
+        if (index >= firstVisible && index < endVisible)
+        {
+            isAssigned[static_cast<size_t> (index - firstVisible)] = true;
+            strip->setBounds (index * mStripWidth, 0, mStripWidth, mContent.getHeight());
+            continue;
+        }
+
+        if (index != Strip::kUnassigned)
+            strip->unassign();
+
+        free.push_back (strip.get());
+    }
+
+    // Assign a strip component to every visible strip which doesn't have one yet.
+    for (int index = firstVisible; index < endVisible; ++index)
+    {
+        if (isAssigned[static_cast<size_t> (index - firstVisible)])
+            continue;
+
+        Strip* strip;
+        if (free.empty())
+        {
+            mStrips.push_back (std::make_unique<Strip> (mScale, mOptions));
+            strip = mStrips.back().get();
+            mContent.addChildComponent (*strip);
+        }
+        else
+        {
+            strip = free.back();
+            free.pop_back();
+        }
+
+        strip->setBounds (index * mStripWidth, 0, mStripWidth, mContent.getHeight());
+        strip->assign (index, *mAccumulators[static_cast<size_t> (index)]);
+    }
+}
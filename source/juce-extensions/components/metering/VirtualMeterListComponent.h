@@ -0,0 +1,92 @@
+#pragma once
+
+#include "LevelMeterComponent.h"
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
+#include <memory>
+#include <vector>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+/**
+ * A scrollable row of meter strips, one for each level meter, which only creates components for the strips which are
+ * visible. Strips which scroll out of view return their LevelMeterComponent to a pool, which makes the cost per frame
+ * proportional to the number of visible strips rather than to the total number of strips.
+ * Every level meter keeps a cheap subscription which only remembers the most relevant recent peak per channel, so that
+ * a strip which scrolls into view can catch up with the peak hold it would have shown.
+ */
+class VirtualMeterListComponent : public juce::Viewport
+{
+public:
+    /// The default width of a single strip.
+    static constexpr int kDefaultStripWidth = 24;
+
+    /**
+     * Constructor.
+     * @param scale The scale to use for all strips.
+     * @param options The options to use for all strips.
+     */
+    explicit VirtualMeterListComponent (
+        const LevelMeter::Scale& scale = LevelMeter::Scale::getDefaultScale(),
+        const LevelMeterComponent::Options& options = LevelMeterComponent::Options::getDefault());
+
+    ~VirtualMeterListComponent() override;
+
+    /**
+     * Adds a strip for given level meter to the end of the list.
+     * @param levelMeter The level meter to show.
+     */
+    void addLevelMeter (LevelMeter& levelMeter);
+
+    /**
+     * Removes all strips.
+     */
+    void clearLevelMeters();
+
+    /**
+     * @return The total number of strips.
+     */
+    [[nodiscard]] int getNumStrips() const;
+
+    /**
+     * @return The number of strips which currently have a component.
+     */
+    [[nodiscard]] int getNumVisibleStrips() const;
+
+    /**
+     * Sets the width of a single strip.
+     * @param stripWidth The width in pixels.
+     */
+    void setStripWidth (int stripWidth);
+
+    // MARK: juce::Viewport overrides -
+    void resized() override;
+    void visibleAreaChanged (const juce::Rectangle<int>& newVisibleArea) override;
+
+private:
+    class PeakAccumulator;
+    class Strip;
+
+    const LevelMeter::Scale& mScale;
+    LevelMeterComponent::Options mOptions;
+    int mStripWidth { kDefaultStripWidth };
+
+    /// The component which holds the visible strips, sized to fit all strips.
+    juce::Component mContent;
+
+    /// An accumulator for every level meter, in the order of the strips.
+    std::vector<std::unique_ptr<PeakAccumulator>> mAccumulators;
+
+    /// All strip components, both the visible ones and the ones in the pool.
+    std::vector<std::unique_ptr<Strip>> mStrips;
+
+    /**
+     * Resizes the content to fit all strips, which also updates the visible strips.
+     */
+    void updateContentSize();
+
+    /**
+     * Assigns a strip component to every visible strip, and returns the other components to the pool.
+     */
+    void updateVisibleStrips();
+};
@@ -0,0 +1,32 @@
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+/// The category of tests which measure performance. These only run when passing --benchmarks.
+static const juce::String kBenchmarkCategory = "Benchmarks";
+
+int main (int argc, char* argv[])
+{
+    const juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure (false);
+
+    if (argc > 1 && juce::String (argv[1]) == "--benchmarks")
+    {
+        runner.runTestsInCategory (kBenchmarkCategory);
+    }
+    else
+    {
+        for (auto& category : juce::UnitTest::getAllCategories())
+        {
+            if (category != kBenchmarkCategory)
+                runner.runTestsInCategory (category);
+        }
+    }
+
+    int numFailures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult (i)->failures;
+
+    return numFailures > 0 ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+#include "juce-extensions/audio/metering/FastDecibels.h"
+
+#include <vector>
+
+/**
+ * Compares the speed of the scalar and batch conversions of FastDecibels with juce::Decibels. Run with --benchmarks.
+ */
+class FastDecibelsBenchmarks : public juce::UnitTest
+{
+public:
+    FastDecibelsBenchmarks() : juce::UnitTest ("FastDecibels", "Benchmarks") {}
+
+    void runTest() override
+    {
+        beginTest ("gainToDecibels()");
+        {
+            runBenchmark<float, gainToDecibelsJuce<float>, gainToDecibelsFast<float>, gainsToDecibelsFast<float>> (
+                createGains<float>());
+            runBenchmark<double, gainToDecibelsJuce<double>, gainToDecibelsFast<double>, gainsToDecibelsFast<double>> (
+                createGains<double>());
+        }
+
+        beginTest ("decibelsToGain()");
+        {
+            runBenchmark<float, decibelsToGainJuce<float>, decibelsToGainFast<float>, decibelsToGainsFast<float>> (
+                createDecibels<float>());
+            runBenchmark<double, decibelsToGainJuce<double>, decibelsToGainFast<double>, decibelsToGainsFast<double>> (
+                createDecibels<double>());
+        }
+    }
+
+private:
+    static constexpr int kNumValues = 4096;
+    static constexpr int kNumRepetitions = 500;
+    static constexpr double kMinusInfinityDb = -100.0;
+
+    template <typename SampleType>
+    static SampleType gainToDecibelsJuce (SampleType gain)
+    {
+        return juce::Decibels::gainToDecibels (gain, static_cast<SampleType> (kMinusInfinityDb));
+    }
+
+    template <typename SampleType>
+    static SampleType gainToDecibelsFast (SampleType gain)
+    {
+        return FastDecibels::gainToDecibels (gain, static_cast<SampleType> (kMinusInfinityDb));
+    }
+
+    template <typename SampleType>
+    static SampleType decibelsToGainJuce (SampleType decibels)
+    {
+        return juce::Decibels::decibelsToGain (decibels, static_cast<SampleType> (kMinusInfinityDb));
+    }
+
+    template <typename SampleType>
+    static SampleType decibelsToGainFast (SampleType decibels)
+    {
+        return FastDecibels::decibelsToGain (decibels, static_cast<SampleType> (kMinusInfinityDb));
+    }
+
+    template <typename SampleType>
+    static void gainsToDecibelsFast (const SampleType* gains, SampleType* decibels, int numValues)
+    {
+        FastDecibels::gainsToDecibels (gains, decibels, numValues, static_cast<SampleType> (kMinusInfinityDb));
+    }
+
+    template <typename SampleType>
+    static void decibelsToGainsFast (const SampleType* decibels, SampleType* gains, int numValues)
+    {
+        FastDecibels::decibelsToGains (decibels, gains, numValues, static_cast<SampleType> (kMinusInfinityDb));
+    }
+
+    /**
+     * @return Gains spread evenly over (0, 1).
+     */
+    template <typename SampleType>
+    static std::vector<SampleType> createGains()
+    {
+        std::vector<SampleType> gains (kNumValues);
+        for (size_t i = 0; i < gains.size(); ++i)
+            gains[i] = static_cast<SampleType> ((static_cast<double> (i) + 0.5) / kNumValues);
+        return gains;
+    }
+
+    /**
+     * @return Levels spread evenly over (kMinusInfinityDb, 0).
+     */
+    template <typename SampleType>
+    static std::vector<SampleType> createDecibels()
+    {
+        std::vector<SampleType> decibels (kNumValues);
+        for (size_t i = 0; i < decibels.size(); ++i)
+            decibels[i] = static_cast<SampleType> (kMinusInfinityDb * (static_cast<double> (i) + 0.5) / kNumValues);
+        return decibels;
+    }
+
+    /// A conversion, passed as a template argument so it's inlined into the measured loop.
+    template <typename SampleType>
+    using Conversion = SampleType (*) (SampleType);
+
+    /// A batch conversion, see Conversion.
+    template <typename SampleType>
+    using BatchConversion = void (*) (const SampleType*, SampleType*, int);
+
+    /**
+     * @return The number of nanoseconds per conversion.
+     */
+    template <typename SampleType, Conversion<SampleType> function>
+    static double measure (const std::vector<SampleType>& values)
+    {
+        std::vector<SampleType> results (values.size());
+
+        auto const startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int r = 0; r < kNumRepetitions; ++r)
+        {
+            for (size_t i = 0; i < values.size(); ++i)
+                results[i] = function (values[i]);
+
+            // Keeps the compiler from dropping repetitions.
+            juce::ignoreUnused (*static_cast<volatile SampleType*> (results.data()));
+        }
+
+        auto const elapsedTicks = juce::Time::getHighResolutionTicks() - startTicks;
+        auto const seconds = juce::Time::highResolutionTicksToSeconds (elapsedTicks);
+        return seconds * 1e9 / (static_cast<double> (values.size()) * kNumRepetitions);
+    }
+
+    /**
+     * @return The number of nanoseconds per converted value.
+     */
+    template <typename SampleType, BatchConversion<SampleType> function>
+    static double measureBatch (const std::vector<SampleType>& values)
+    {
+        std::vector<SampleType> results (values.size());
+
+        auto const startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int r = 0; r < kNumRepetitions; ++r)
+        {
+            function (values.data(), results.data(), static_cast<int> (values.size()));
+
+            // Keeps the compiler from dropping repetitions.
+            juce::ignoreUnused (*static_cast<volatile SampleType*> (results.data()));
+        }
+
+        auto const elapsedTicks = juce::Time::getHighResolutionTicks() - startTicks;
+        auto const seconds = juce::Time::highResolutionTicksToSeconds (elapsedTicks);
+        return seconds * 1e9 / (static_cast<double> (values.size()) * kNumRepetitions);
+    }
+
+    template <
+        typename SampleType,
+        Conversion<SampleType> juceConversion,
+        Conversion<SampleType> fastConversion,
+        BatchConversion<SampleType> batchConversion>
+    void runBenchmark (const std::vector<SampleType>& values)
+    {
+        auto const juceNs = measure<SampleType, juceConversion> (values);
+        auto const fastNs = measure<SampleType, fastConversion> (values);
+        auto const batchNs = measureBatch<SampleType, batchConversion> (values);
+
+        logMessage (juce::String (std::is_same_v<SampleType, float> ? "float" : "double") + ": juce::Decibels "
+                    + juce::String (juceNs, 2) + " ns, FastDecibels " + juce::String (fastNs, 2)
+                    + " ns, FastDecibels batch " + juce::String (batchNs, 2) + " ns");
+    }
+};
+
+static FastDecibelsBenchmarks fastDecibelsBenchmarks;
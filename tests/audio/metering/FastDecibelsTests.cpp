@@ -0,0 +1,202 @@
+#include "juce-extensions/audio/metering/FastDecibels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+class FastDecibelsTests : public juce::UnitTest
+{
+public:
+    FastDecibelsTests() : juce::UnitTest ("FastDecibels", "Metering") {}
+
+    void runTest() override
+    {
+        beginTest ("gainToDecibels() stays within the documented error of juce::Decibels");
+        {
+            expectLessOrEqual (getMaxGainToDecibelsError<float> (false), 3e-5);
+            expectLessOrEqual (getMaxGainToDecibelsError<double> (false), 4e-12);
+        }
+
+        beginTest ("decibelsToGain() stays within the documented error of juce::Decibels");
+        {
+            expectLessOrEqual (getMaxDecibelsToGainError<float> (false), 1e-6);
+            expectLessOrEqual (getMaxDecibelsToGainError<double> (false), 2e-14);
+        }
+
+        beginTest ("gainsToDecibels() stays within the documented error of juce::Decibels");
+        {
+            expectLessOrEqual (getMaxGainToDecibelsError<float> (true), 3e-5);
+            expectLessOrEqual (getMaxGainToDecibelsError<double> (true), 4e-12);
+        }
+
+        beginTest ("decibelsToGains() stays within the documented error of juce::Decibels");
+        {
+            expectLessOrEqual (getMaxDecibelsToGainError<float> (true), 1e-6);
+            expectLessOrEqual (getMaxDecibelsToGainError<double> (true), 2e-14);
+        }
+
+        beginTest ("Gains without a level map to minus infinity");
+        {
+            expectSpecialValues<float>();
+            expectSpecialValues<double>();
+        }
+
+        beginTest ("Batch conversions handle the same special values as the scalar conversions");
+        {
+            expectBatchSpecialValues<float>();
+            expectBatchSpecialValues<double>();
+        }
+    }
+
+private:
+    static constexpr double kMinDecibels = -140.0;
+    static constexpr double kMaxDecibels = 20.0;
+    static constexpr double kMinusInfinityDb = kMinDecibels - 20.0;
+    static constexpr int kNumSteps = 200000;
+
+    /**
+     * @return The level in decibels of the given step of the tested range.
+     */
+    static double getDecibelsForStep (int const step)
+    {
+        return kMinDecibels + (kMaxDecibels - kMinDecibels) * step / kNumSteps;
+    }
+
+    /**
+     * @return The values of the tested range, converted by either the scalar or the batch conversion. The odd number of
+     * values also covers the scalar remainder of the batch conversion.
+     */
+    template <typename SampleType, typename Scalar, typename Batch>
+    static std::vector<SampleType>
+        convert (std::vector<SampleType> values, bool const useBatch, Scalar&& scalar, Batch&& batch)
+    {
+        if (useBatch)
+            batch (values.data(), values.data(), static_cast<int> (values.size()));
+        else
+            std::transform (values.begin(), values.end(), values.begin(), scalar);
+
+        return values;
+    }
+
+    /**
+     * @return The maximum absolute error in decibels over the tested range. The reference is calculated in double
+     * precision, so only the error of the approximation is measured.
+     */
+    template <typename SampleType>
+    static double getMaxGainToDecibelsError (bool const useBatch)
+    {
+        auto const minusInfinityDb = static_cast<SampleType> (kMinusInfinityDb);
+
+        std::vector<SampleType> gains;
+        for (int step = 0; step <= kNumSteps; ++step)
+            gains.push_back (static_cast<SampleType> (std::pow (10.0, getDecibelsForStep (step) / 20.0)));
+
+        auto const decibels = convert (
+            gains,
+            useBatch,
+            [minusInfinityDb] (SampleType gain) {
+                return FastDecibels::gainToDecibels (gain, minusInfinityDb);
+            },
+            [minusInfinityDb] (const SampleType* values, SampleType* results, int numValues) {
+                FastDecibels::gainsToDecibels (values, results, numValues, minusInfinityDb);
+            });
+
+        double maxError = 0.0;
+        for (size_t i = 0; i < gains.size(); ++i)
+        {
+            auto const expected = juce::Decibels::gainToDecibels (static_cast<double> (gains[i]), kMinusInfinityDb);
+            maxError = std::max (maxError, std::abs (static_cast<double> (decibels[i]) - expected));
+        }
+
+        return maxError;
+    }
+
+    /**
+     * @return The maximum error relative to the gain over the tested range.
+     */
+    template <typename SampleType>
+    static double getMaxDecibelsToGainError (bool const useBatch)
+    {
+        auto const minusInfinityDb = static_cast<SampleType> (kMinusInfinityDb);
+
+        std::vector<SampleType> decibels;
+        for (int step = 0; step <= kNumSteps; ++step)
+            decibels.push_back (static_cast<SampleType> (getDecibelsForStep (step)));
+
+        auto const gains = convert (
+            decibels,
+            useBatch,
+            [minusInfinityDb] (SampleType level) {
+                return FastDecibels::decibelsToGain (level, minusInfinityDb);
+            },
+            [minusInfinityDb] (const SampleType* values, SampleType* results, int numValues) {
+                FastDecibels::decibelsToGains (values, results, numValues, minusInfinityDb);
+            });
+
+        double maxError = 0.0;
+        for (size_t i = 0; i < decibels.size(); ++i)
+        {
+            auto const expected = juce::Decibels::decibelsToGain (static_cast<double> (decibels[i]), kMinusInfinityDb);
+            maxError = std::max (maxError, std::abs (static_cast<double> (gains[i]) - expected) / expected);
+        }
+
+        return maxError;
+    }
+
+    template <typename SampleType>
+    void expectSpecialValues()
+    {
+        auto const minusInfinityDb = SampleType (-100);
+
+        for (auto const gain : { SampleType (0),
+                                 SampleType (-0.5),
+                                 std::numeric_limits<SampleType>::denorm_min(),
+                                 std::numeric_limits<SampleType>::quiet_NaN() })
+        {
+            expectEquals (FastDecibels::gainToDecibels (gain, minusInfinityDb), minusInfinityDb);
+        }
+
+        expectEquals (FastDecibels::decibelsToGain (minusInfinityDb, minusInfinityDb), SampleType (0));
+        expectEquals (FastDecibels::decibelsToGain (SampleType (-200), minusInfinityDb), SampleType (0));
+        expectEquals (FastDecibels::gainToDecibels (SampleType (1e-6), minusInfinityDb), minusInfinityDb);
+    }
+
+    /**
+     * Converts special values in a batch, which is long enough for the SSE2 path, and compares with the scalar results.
+     */
+    template <typename SampleType>
+    void expectBatchSpecialValues()
+    {
+        auto const minusInfinityDb = SampleType (-100);
+
+        std::vector<SampleType> const values { SampleType (0),
+                                               SampleType (-0.5),
+                                               std::numeric_limits<SampleType>::denorm_min(),
+                                               std::numeric_limits<SampleType>::quiet_NaN(),
+                                               std::numeric_limits<SampleType>::infinity(),
+                                               std::numeric_limits<SampleType>::max(),
+                                               SampleType (1e-6),
+                                               SampleType (-200),
+                                               minusInfinityDb,
+                                               SampleType (1),
+                                               SampleType (4000),
+                                               -std::numeric_limits<SampleType>::infinity() };
+
+        auto const numValues = static_cast<int> (values.size());
+
+        std::vector<SampleType> decibels (values.size());
+        FastDecibels::gainsToDecibels (values.data(), decibels.data(), numValues, minusInfinityDb);
+
+        std::vector<SampleType> gains (values.size());
+        FastDecibels::decibelsToGains (values.data(), gains.data(), numValues, minusInfinityDb);
+
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            expectEquals (decibels[i], FastDecibels::gainToDecibels (values[i], minusInfinityDb));
+            expectEquals (gains[i], FastDecibels::decibelsToGain (values[i], minusInfinityDb));
+        }
+    }
+};
+
+static FastDecibelsTests fastDecibelsTests;
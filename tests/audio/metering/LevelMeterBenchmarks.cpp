@@ -0,0 +1,135 @@
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * Compares dispatching the measurements of a refresh to the subscribers of a level meter one measurement at a time,
+ * which the refresh did before, with a single batch per subscriber. Run with --benchmarks.
+ */
+class LevelMeterBenchmarks : public juce::UnitTest
+{
+public:
+    LevelMeterBenchmarks() : juce::UnitTest ("LevelMeter", "Benchmarks") {}
+
+    void runTest() override
+    {
+        beginTest ("Subscriber dispatch");
+        {
+            for (auto const numChannels : { 2, 64 })
+            {
+                runDispatchBenchmark<DefaultSubscriber> ("default batch", numChannels);
+                runDispatchBenchmark<BatchSubscriber> ("overridden batch", numChannels);
+            }
+        }
+    }
+
+private:
+    static constexpr int kNumSubscribers = 8;
+    static constexpr int kBlocksPerRefresh = 4;
+    static constexpr int kNumRefreshes = 20000;
+
+    /**
+     * A subscriber which only overrides updateWithMeasurement(), so a batch is handled by the default implementation
+     * of updateWithMeasurements(). Does as little as possible per measurement, so that the dispatch dominates.
+     */
+    class DefaultSubscriber : public LevelMeter::Subscriber
+    {
+    public:
+        DefaultSubscriber() : Subscriber (LevelMeter::Scale::getDefaultScale()) {}
+
+        double sum = 0.0;
+
+        void updateWithMeasurement (const LevelMeter::Measurement& measurement) override
+        {
+            sum += measurement.peakLevel;
+        }
+
+    private:
+        void levelMeterPrepared ([[maybe_unused]] int numChannels) override {}
+    };
+
+    /**
+     * A subscriber which overrides updateWithMeasurements() with a non-virtual loop, like the subscribers of
+     * MeterBridgeComponent and VirtualMeterListComponent.
+     */
+    class BatchSubscriber final : public DefaultSubscriber
+    {
+    public:
+        void updateWithMeasurements (const LevelMeter::Measurement* measurements, int const numMeasurements) override
+        {
+            for (int i = 0; i < numMeasurements; ++i)
+                BatchSubscriber::updateWithMeasurement (measurements[i]);
+        }
+    };
+
+    /**
+     * Dispatches the measurements of every refresh through an rdk::SubscriberList, the way the refresh of a level
+     * meter does, once per measurement and once per refresh.
+     */
+    template <typename SubscriberType>
+    void runDispatchBenchmark (const char* name, int const numChannels)
+    {
+        std::vector<LevelMeter::Measurement> measurements (static_cast<size_t> (numChannels * kBlocksPerRefresh));
+        for (size_t i = 0; i < measurements.size(); ++i)
+        {
+            measurements[i].channelIndex = static_cast<int> (i) % numChannels;
+            measurements[i].peakLevel = 0.5;
+        }
+
+        // Declared in this order so that the subscriptions end first.
+        rdk::SubscriberList<LevelMeter::Subscriber> subscriberList;
+        std::vector<std::unique_ptr<SubscriberType>> subscribers;
+        std::vector<rdk::Subscription> subscriptions;
+
+        for (int i = 0; i < kNumSubscribers; ++i)
+        {
+            subscribers.push_back (std::make_unique<SubscriberType>());
+            subscriptions.push_back (subscriberList.add (subscribers.back().get()));
+        }
+
+        auto const perMeasurementNs = measureNanosecondsPerMeasurement (measurements, [&] {
+            for (auto const& measurement : measurements)
+            {
+                subscriberList.call ([&measurement] (LevelMeter::Subscriber& s) {
+                    s.updateWithMeasurement (measurement);
+                });
+            }
+        });
+
+        auto const batchNs = measureNanosecondsPerMeasurement (measurements, [&] {
+            subscriberList.call ([&measurements] (LevelMeter::Subscriber& s) {
+                s.updateWithMeasurements (measurements.data(), static_cast<int> (measurements.size()));
+            });
+        });
+
+        double sum = 0.0;
+        for (auto const& subscriber : subscribers)
+            sum += subscriber->sum;
+
+        // Logging the sum keeps the compiler from dropping refreshes.
+        logMessage (juce::String (name) + ", " + juce::String (numChannels) + " channels: per measurement "
+                    + juce::String (perMeasurementNs, 2) + " ns, batch " + juce::String (batchNs, 2)
+                    + " ns per measurement and subscriber (sum " + juce::String (sum) + ")");
+    }
+
+    /**
+     * @return The number of nanoseconds per measurement and subscriber.
+     */
+    template <typename Function>
+    static double measureNanosecondsPerMeasurement (
+        const std::vector<LevelMeter::Measurement>& measurements,
+        Function refresh)
+    {
+        auto const startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int r = 0; r < kNumRefreshes; ++r)
+            refresh();
+
+        auto const elapsedTicks = juce::Time::getHighResolutionTicks() - startTicks;
+        auto const seconds = juce::Time::highResolutionTicksToSeconds (elapsedTicks);
+        return seconds * 1e9 / (static_cast<double> (measurements.size()) * kNumSubscribers * kNumRefreshes);
+    }
+};
+
+static LevelMeterBenchmarks levelMeterBenchmarks;
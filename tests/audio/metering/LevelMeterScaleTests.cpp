@@ -0,0 +1,152 @@
+#include "juce-extensions/audio/metering/LevelMeter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+class LevelMeterScaleTests : public juce::UnitTest
+{
+public:
+    LevelMeterScaleTests() : juce::UnitTest ("LevelMeter::Scale", "Metering") {}
+
+    void runTest() override
+    {
+        beginTest ("Mapping a batch of levels gives the same results as mapping every level");
+        {
+            auto const& scale = LevelMeter::Scale::getDefaultScale();
+
+            std::vector<double> levels { 0.0, -0.5, 2.0, std::numeric_limits<double>::quiet_NaN(), 1.0 };
+            for (double db = -160.0; db <= 6.0; db += 0.37)
+                levels.push_back (std::pow (10.0, db * 0.05));
+
+            std::vector<double> proportions (levels.size());
+            scale.calculateProportionsForLevels (levels.data(), proportions.data(), static_cast<int> (levels.size()));
+
+            for (size_t i = 0; i < levels.size(); ++i)
+                expectEquals (proportions[i], scale.calculateProportionForLevel (levels[i]));
+        }
+
+        beginTest ("Levels can be mapped in place");
+        {
+            auto const& scale = LevelMeter::Scale::getDefaultScale();
+
+            std::vector<double> values { 0.001, 0.01, 0.1, 0.5, 1.0 };
+            auto const expected = values;
+            scale.calculateProportionsForLevels (values.data(), values.data(), static_cast<int> (values.size()));
+
+            for (size_t i = 0; i < values.size(); ++i)
+                expectEquals (values[i], scale.calculateProportionForLevel (expected[i]));
+        }
+
+        beginTest ("The lookup table of the default scale stays within the documented error");
+        {
+            auto const& scale = LevelMeter::Scale::getDefaultScale();
+
+            expect (scale.getLookupTableMaxError() > 0.0); // The table is in use.
+            expectLessOrEqual (scale.getLookupTableMaxError(), 0.00003);
+        }
+
+        beginTest ("Levels spread densely over the default scale stay within the documented error");
+        {
+            auto const& scale = LevelMeter::Scale::getDefaultScale();
+            auto const levels = getDenseLevels (scale);
+
+            expectLessOrEqual (getMaxProportionError (scale, levels), 0.00003);
+            expectLessOrEqual (getMaxErrorDb (scale, levels), 0.0011);
+        }
+
+        beginTest ("Divisions in neighbouring cells of the lookup table each split their own cell");
+        {
+            // About 0.19 dB per cell, so these divisions lie in neighbouring cells.
+            LevelMeter::Scale const scale (-60.0, { -60.0, -20.0, -10.2, -10.0, 0.0 });
+            auto const levels = getDenseLevels (scale);
+
+            expect (scale.getLookupTableMaxError() > 0.0);
+            expectLessOrEqual (getMaxErrorDb (scale, levels), 0.0011);
+        }
+
+        beginTest ("Divisions which share a cell of the lookup table use the exact mapping");
+        {
+            LevelMeter::Scale const scale (-60.0, { -60.0, -20.0, -10.01, -10.0, 0.0 });
+            auto const levels = getDenseLevels (scale);
+
+            // Without a table, the only error is that of FastDecibels::gainToDecibels().
+            expectEquals (scale.getLookupTableMaxError(), 0.0);
+            expectLessOrEqual (getMaxErrorDb (scale, levels), 3e-5 + 1e-9);
+            expectLessOrEqual (getMaxProportionError (scale, levels), 0.001);
+        }
+    }
+
+private:
+    /// The number of levels per decibel for getDenseLevels(), which gives about 100 levels per cell of the table.
+    static constexpr int kLevelsPerDecibel = 500;
+
+    /**
+     * @return Levels spread densely over the whole range of the scale and beyond, plus the level of every division
+     * and its direct neighbours, so that the cells which are split by a division are covered at the split.
+     */
+    static std::vector<double> getDenseLevels (const LevelMeter::Scale& scale)
+    {
+        std::vector<double> levels;
+
+        auto const& divisions = scale.getDivisions();
+        auto const numSteps = static_cast<int> ((divisions.back() - divisions.front() + 20.0) * kLevelsPerDecibel);
+        for (int step = 0; step <= numSteps; ++step)
+        {
+            auto const db = divisions.front() - 10.0 + static_cast<double> (step) / kLevelsPerDecibel;
+            levels.push_back (std::pow (10.0, db * 0.05));
+        }
+
+        for (auto const division : divisions)
+        {
+            auto const level = std::pow (10.0, division * 0.05);
+            levels.push_back (std::nextafter (level, 0.0));
+            levels.push_back (level);
+            levels.push_back (std::nextafter (level, 2.0));
+        }
+
+        return levels;
+    }
+
+    /**
+     * @return The maximum difference in proportion between calculateProportionForLevel() and the exact mapping.
+     */
+    static double getMaxProportionError (const LevelMeter::Scale& scale, const std::vector<double>& levels)
+    {
+        double maxError = 0.0;
+
+        for (auto const level : levels)
+        {
+            auto const exact = scale.calculateProportionForLevelDb (
+                juce::Decibels::gainToDecibels (level, scale.getMinusInfinityDb()));
+            maxError = std::max (maxError, std::abs (scale.calculateProportionForLevel (level) - exact));
+        }
+
+        return maxError;
+    }
+
+    /**
+     * @return The maximum error in decibels of calculateProportionForLevel(), found by mapping the proportion back to
+     * a level. Only levels within the divisions are used, outside of them all levels map to the same proportion.
+     */
+    static double getMaxErrorDb (const LevelMeter::Scale& scale, const std::vector<double>& levels)
+    {
+        auto const& divisions = scale.getDivisions();
+        double maxError = 0.0;
+
+        for (auto const level : levels)
+        {
+            auto const levelDb = 20.0 * std::log10 (level);
+            if (!(levelDb > divisions.front() && levelDb < divisions.back()))
+                continue;
+
+            auto const mappedDb = scale.calculateLevelDbForProportion (scale.calculateProportionForLevel (level));
+            maxError = std::max (maxError, std::abs (mappedDb - levelDb));
+        }
+
+        return maxError;
+    }
+};
+
+static LevelMeterScaleTests levelMeterScaleTests;
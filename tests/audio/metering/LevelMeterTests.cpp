@@ -0,0 +1,361 @@
+#include "juce-extensions/audio/metering/LevelMeter.h"
+#include "juce-extensions/audio/metering/LevelMeterSnapshotReader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+class LevelMeterTests : public juce::UnitTest
+{
+public:
+    LevelMeterTests() : juce::UnitTest ("LevelMeter", "Metering") {}
+
+    void runTest() override
+    {
+        beginTest ("A default stereo meter logs overload events");
+        {
+            LevelMeter levelMeter;
+            levelMeter.prepareToPlay (2, kSampleRate);
+
+            std::vector<float> left (kBlockSize, 0.f);
+            std::vector<float> right (kBlockSize, 0.f);
+            std::fill (left.begin() + 10, left.begin() + 15, 1.5f);
+
+            const float* channels[] = { left.data(), right.data() };
+            levelMeter.measureBlock (channels, 2, kBlockSize);
+            levelMeter.poll();
+
+            auto const& log = levelMeter.getOverloadLog();
+            expectEquals (log.getNumEvents (0), int64_t (1));
+            expectEquals (log.getNumOverloadedSamples (0), int64_t (5));
+            expectEquals (log.getNumEvents (1), int64_t (0));
+        }
+
+        beginTest ("The overloaded flag follows the minimum run length of the clip detector");
+        {
+            LevelMeter levelMeter;
+            levelMeter.prepareToPlay (2, kSampleRate);
+            levelMeter.setClipDetectorOptions ({ 1.f, 4 });
+
+            OverloadSubscriber subscriber (levelMeter);
+
+            std::vector<float> left (kBlockSize, 0.f);
+            std::vector<float> right (kBlockSize, 0.f);
+            std::fill (left.begin() + 10, left.begin() + 13, 1.5f);  // A run of 3 samples, too short.
+            std::fill (right.begin() + 10, right.begin() + 14, 1.5f); // A run of 4 samples.
+
+            const float* channels[] = { left.data(), right.data() };
+            levelMeter.measureBlock (channels, 2, kBlockSize);
+            levelMeter.poll();
+
+            expect (!subscriber.isOverloaded (0));
+            expect (subscriber.isOverloaded (1));
+            expectEquals (levelMeter.getOverloadLog().getNumEvents (0), int64_t (0));
+            expectEquals (levelMeter.getOverloadLog().getNumEvents (1), int64_t (1));
+        }
+
+        beginTest ("The default queue holds the blocks of the slowest refresh interval without dropping");
+        {
+            LevelMeter levelMeter;
+            levelMeter.prepareToPlay (4, kSampleRate);
+
+            std::vector<float> silence (kSmallBlockSize, 0.f);
+            const float* channels[] = { silence.data(), silence.data(), silence.data(), silence.data() };
+
+            // Without a refresh for the interval of the background refresh group, with the smallest expected blocks.
+            auto const numBlocks = static_cast<int> (LevelMeterConstants::kMaxBlocksPerSecond)
+                                   / LevelMeterConstants::kBackgroundRefreshRateHz;
+
+            for (int i = 0; i < numBlocks; ++i)
+                levelMeter.measureBlock (channels, 4, kSmallBlockSize);
+
+            expectEquals (levelMeter.getNumDroppedMeasurements(), int64_t (0));
+
+            // Measurements which don't fit are dropped instead of growing the queue on the audio thread.
+            for (int i = 0; i < numBlocks; ++i)
+                levelMeter.measureBlock (channels, 4, kSmallBlockSize);
+
+            expectGreaterThan (levelMeter.getNumDroppedMeasurements(), int64_t (0));
+        }
+
+        beginTest ("Child meters feed the history and overload log of their parent through the channel map");
+        {
+            LevelMeter parent;
+            parent.prepareToPlay (2, kSampleRate);
+            parent.setHistoryOptions ({ { { 10.0, 100 } } });
+
+            LevelMeter childA;
+            childA.prepareToPlay (2, kSampleRate);
+            parent.addChildMeter (childA);
+
+            LevelMeter childB;
+            childB.prepareToPlay (2, kSampleRate);
+            parent.addChildMeter (childB, { 0, -1 }); // Only the left channel.
+
+            auto const samplesPerFrame = static_cast<int> (kSampleRate / 100.0);
+            std::vector<float> quiet (static_cast<size_t> (samplesPerFrame), 0.25f);
+            std::vector<float> loud (static_cast<size_t> (samplesPerFrame), 0.5f);
+            std::vector<float> clipped (static_cast<size_t> (samplesPerFrame), 0.1f);
+            std::fill (clipped.begin() + 10, clipped.begin() + 15, 1.5f);
+
+            const float* channelsA[] = { loud.data(), quiet.data() };
+            const float* channelsB[] = { clipped.data(), clipped.data() };
+
+            for (int i = 0; i < kNumFrames; ++i)
+            {
+                childA.measureBlock (channelsA, 2, samplesPerFrame);
+                childB.measureBlock (channelsB, 2, samplesPerFrame);
+            }
+
+            childA.poll();
+            childB.poll();
+            parent.poll();
+
+            // Both sources of the left channel advance its history together, not one after the other.
+            auto const& history = parent.getHistory();
+            expectEquals (history.getNumFramesWritten (0, 0), int64_t (kNumFrames));
+            expectEquals (history.getNumFramesWritten (1, 0), int64_t (kNumFrames));
+            expectEquals (getMaxLevel (history, 0), 1.5f);
+            expectEquals (getMaxLevel (history, 1), 0.25f);
+
+            // The right channel of childB is left out.
+            auto const& log = parent.getOverloadLog();
+            expectEquals (log.getNumEvents (0), int64_t (kNumFrames));
+            expectEquals (log.getNumEvents (1), int64_t (0));
+        }
+
+        beginTest ("A child meter which is destroyed before its parent removes itself from the parent");
+        {
+            LevelMeter parent;
+            parent.prepareToPlay (2, kSampleRate);
+            parent.setHistoryOptions ({ { { 10.0, 100 } } });
+
+            auto destroyedChild = std::make_unique<LevelMeter>();
+            destroyedChild->prepareToPlay (2, kSampleRate);
+            parent.addChildMeter (*destroyedChild);
+            destroyedChild.reset();
+
+            LevelMeter child;
+            child.prepareToPlay (2, kSampleRate);
+            parent.addChildMeter (child);
+
+            auto const samplesPerFrame = static_cast<int> (kSampleRate / 100.0);
+            std::vector<float> samples (static_cast<size_t> (samplesPerFrame), 0.5f);
+            const float* channels[] = { samples.data(), samples.data() };
+
+            for (int i = 0; i < kNumFrames; ++i)
+                child.measureBlock (channels, 2, samplesPerFrame);
+
+            child.poll();
+            parent.poll();
+
+            // The destroyed child no longer counts as a source, so the history keeps the pace of the remaining child.
+            expectEquals (parent.getHistory().getNumFramesWritten (0, 0), int64_t (kNumFrames));
+            expectEquals (parent.getHistory().getNumFramesWritten (1, 0), int64_t (kNumFrames));
+        }
+
+        beginTest ("A parent meter which is destroyed before its child removes itself from the child");
+        {
+            LevelMeter child;
+            child.prepareToPlay (2, kSampleRate);
+
+            {
+                LevelMeter parent;
+                parent.prepareToPlay (2, kSampleRate);
+                parent.addChildMeter (child);
+            }
+
+            std::vector<float> samples (kBlockSize, 0.5f);
+            const float* channels[] = { samples.data(), samples.data() };
+            child.measureBlock (channels, 2, kBlockSize);
+
+            expect (child.poll());
+        }
+
+        beginTest ("Interleaved and planar PCM blocks give the same measurements");
+        {
+            LevelMeter interleavedMeter;
+            interleavedMeter.prepareToPlay (3, kSampleRate);
+            MeasurementRecorder interleavedRecorder (interleavedMeter);
+
+            LevelMeter planarMeter;
+            planarMeter.prepareToPlay (3, kSampleRate);
+            MeasurementRecorder planarRecorder (planarMeter);
+
+            std::vector<std::vector<int16_t>> channels (3, std::vector<int16_t> (kBlockSize));
+            std::vector<int16_t> frames;
+
+            for (int i = 0; i < kBlockSize; ++i)
+            {
+                channels[0][static_cast<size_t> (i)] = static_cast<int16_t> (i * 100);
+                channels[1][static_cast<size_t> (i)] = static_cast<int16_t> (i % 7 == 0 ? -32768 : -i);
+                channels[2][static_cast<size_t> (i)] = static_cast<int16_t> (i % 2 == 0 ? 16384 : -16384);
+
+                for (auto const& channel : channels)
+                    frames.push_back (channel[static_cast<size_t> (i)]);
+            }
+
+            const void* channelData[] = { channels[0].data(), channels[1].data(), channels[2].data() };
+            LevelMeter::PcmFormat const format { LevelMeter::PcmEncoding::int16 };
+
+            // The same block twice, so that runs of clipped samples straddle a block boundary.
+            for (int i = 0; i < 2; ++i)
+            {
+                interleavedMeter.measureInterleavedBlock (frames.data(), 3, kBlockSize, format);
+                planarMeter.measurePlanarBlock (channelData, 3, kBlockSize, format);
+            }
+
+            interleavedMeter.poll();
+            planarMeter.poll();
+
+            expect (interleavedRecorder.measurements == planarRecorder.measurements);
+            expectEquals (static_cast<int> (interleavedRecorder.measurements.size()), 6);
+
+            for (int ch = 0; ch < 3; ++ch)
+            {
+                expectEquals (
+                    interleavedMeter.getOverloadLog().getNumEvents (ch),
+                    planarMeter.getOverloadLog().getNumEvents (ch));
+            }
+
+            expectGreaterThan (interleavedMeter.getOverloadLog().getNumEvents (1), int64_t (0));
+        }
+
+        beginTest ("Full scale codes of integer PCM count as clipped");
+        {
+            LevelMeter levelMeter;
+            levelMeter.prepareToPlay (2, kSampleRate);
+
+            OverloadSubscriber subscriber (levelMeter);
+
+            std::vector<int16_t> left (kBlockSize, 0);
+            std::vector<int16_t> right (kBlockSize, 0);
+            std::fill (left.begin() + 10, left.begin() + 12, int16_t (32767));
+            std::fill (right.begin() + 10, right.begin() + 12, int16_t (-32768));
+
+            const void* channels[] = { left.data(), right.data() };
+            levelMeter.measurePlanarBlock (channels, 2, kBlockSize, { LevelMeter::PcmEncoding::int16 });
+            levelMeter.poll();
+
+            expect (subscriber.isOverloaded (0));
+            expect (subscriber.isOverloaded (1));
+            expectEquals (levelMeter.getOverloadLog().getNumEvents (0), int64_t (1));
+            expectEquals (levelMeter.getOverloadLog().getNumEvents (1), int64_t (1));
+        }
+
+        beginTest ("Resetting the overloaded flags of a snapshot reader shows in the next snapshot");
+        {
+            LevelMeter levelMeter;
+            levelMeter.prepareToPlay (2, kSampleRate);
+
+            LevelMeterSnapshotReader reader (levelMeter);
+
+            std::vector<float> left (kBlockSize, 0.f);
+            std::vector<float> right (kBlockSize, 0.f);
+            std::fill (left.begin() + 10, left.begin() + 15, 1.5f);
+
+            const float* channels[] = { left.data(), right.data() };
+            levelMeter.measureBlock (channels, 2, kBlockSize);
+            levelMeter.poll();
+
+            auto const& overloaded = reader.read();
+            expectEquals (static_cast<int> (overloaded.channels.size()), 2);
+            expect (overloaded.channels[0].overloaded);
+            expect (!overloaded.channels[1].overloaded);
+
+            reader.resetOverloaded();
+
+            std::fill (left.begin(), left.end(), 0.5f);
+            levelMeter.measureBlock (channels, 2, kBlockSize);
+            levelMeter.poll();
+
+            auto const& reset = reader.read();
+            expect (!reset.channels[0].overloaded);
+            expect (!reset.channels[1].overloaded);
+        }
+    }
+
+private:
+    /**
+     * A subscriber which is only used for its overloaded flags.
+     */
+    class OverloadSubscriber : public LevelMeter::Subscriber
+    {
+    public:
+        using LevelMeter::Subscriber::isOverloaded;
+
+        explicit OverloadSubscriber (LevelMeter& levelMeter) : Subscriber (LevelMeter::Scale::getDefaultScale())
+        {
+            subscribeToLevelMeter (levelMeter);
+        }
+
+        ~OverloadSubscriber() override
+        {
+            unsubscribeFromLevelMeter();
+        }
+
+    private:
+        void levelMeterPrepared ([[maybe_unused]] int numChannels) override {}
+    };
+
+    /**
+     * A subscriber which records every measurement it receives.
+     */
+    class MeasurementRecorder : public LevelMeter::Subscriber
+    {
+    public:
+        /// The fields of a measurement, in a form which can be compared.
+        using RecordedMeasurement = std::tuple<int, double, double, double, int, bool, int, int, int>;
+
+        std::vector<RecordedMeasurement> measurements;
+
+        explicit MeasurementRecorder (LevelMeter& levelMeter) : Subscriber (LevelMeter::Scale::getDefaultScale())
+        {
+            subscribeToLevelMeter (levelMeter);
+        }
+
+        ~MeasurementRecorder() override
+        {
+            unsubscribeFromLevelMeter();
+        }
+
+        void updateWithMeasurement (const LevelMeter::Measurement& m) override
+        {
+            measurements.emplace_back (
+                m.channelIndex,
+                m.peakLevel,
+                m.mean,
+                m.meanSquare,
+                m.numSamples,
+                m.overloaded,
+                m.numNaNs,
+                m.numInfs,
+                m.numDenormals);
+        }
+
+    private:
+        void levelMeterPrepared ([[maybe_unused]] int numChannels) override {}
+    };
+
+    /**
+     * @return The highest level of all frames of the finest resolution of a channel.
+     */
+    static float getMaxLevel (const LevelMeterHistory& history, int const channelIndex)
+    {
+        float maxLevel = 0.f;
+
+        for (int64_t i = 0; i < history.getNumFramesWritten (channelIndex, 0); ++i)
+            maxLevel = std::max (maxLevel, history.getFrame (channelIndex, 0, i).maxLevel);
+
+        return maxLevel;
+    }
+
+    static constexpr double kSampleRate = 48000.0;
+    static constexpr int kBlockSize = 256;
+    static constexpr int kSmallBlockSize = 32;
+    static constexpr int kNumFrames = 10;
+};
+
+static LevelMeterTests levelMeterTests;
@@ -0,0 +1,167 @@
+#include "juce-extensions/audio/metering/MeasurementKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Measures the speed of the measurement kernel for float samples and for decoded PCM samples. Run with --benchmarks.
+ */
+class MeasurementKernelBenchmarks : public juce::UnitTest
+{
+public:
+    MeasurementKernelBenchmarks() : juce::UnitTest ("MeasurementKernel", "Benchmarks") {}
+
+    void runTest() override
+    {
+        beginTest ("float");
+        {
+            std::vector<float> samples (kNumSamples);
+            for (size_t i = 0; i < samples.size(); ++i)
+                samples[i] = static_cast<float> (getTestSignal (i));
+
+            logNanosecondsPerSample ("float", [&] {
+                return MeasurementKernel::measure (
+                    samples.data(), kNumSamples, 1.f, [] (uint64_t, const float*, int, int) {});
+            });
+        }
+
+        beginTest ("PCM");
+        {
+            runPcmBenchmark<int16_t> ("int16", MeasurementKernel::PcmEncoding::int16, 32767.0);
+            runPcmBenchmark<int32_t> ("int24in32", MeasurementKernel::PcmEncoding::int24in32, 8388607.0);
+            runPcmBenchmark<int32_t> ("int32", MeasurementKernel::PcmEncoding::int32, 2147483647.0);
+        }
+
+        beginTest ("Interleaved PCM");
+        {
+            using Encoding = MeasurementKernel::PcmEncoding;
+
+            for (auto const numChannels : { 2, 8, 64 })
+            {
+                runInterleavedBenchmark<int16_t> ("int16", Encoding::int16, numChannels, 32767.0);
+                runInterleavedBenchmark<int32_t> ("int32", Encoding::int32, numChannels, 2147483647.0);
+                runInterleavedBenchmark<float> ("float32", Encoding::float32, numChannels, 1.0);
+            }
+        }
+    }
+
+private:
+    static constexpr int kNumSamples = 4096;
+    static constexpr int kNumRepetitions = 2000;
+
+    /// Interleaved blocks are larger than the caches, so that every pass over the frames reads them from memory.
+    static constexpr int kNumInterleavedSamples = 1 << 22;
+    static constexpr int kNumInterleavedRepetitions = 4;
+
+    static double getTestSignal (size_t const i)
+    {
+        return 0.9 * std::sin (0.01 * static_cast<double> (i));
+    }
+
+    /**
+     * Measures contiguous samples, which are decoded with SSE2 where available, and samples interleaved with a second
+     * channel, which are decoded sample by sample.
+     */
+    template <typename IntType>
+    void runPcmBenchmark (const char* name, MeasurementKernel::PcmEncoding const encoding, double const maxCode)
+    {
+        std::vector<IntType> interleaved (kNumSamples * 2, IntType (0));
+        for (size_t i = 0; i < kNumSamples; ++i)
+            interleaved[i * 2] = static_cast<IntType> (getTestSignal (i) * maxCode);
+
+        std::vector<IntType> contiguous (kNumSamples);
+        for (size_t i = 0; i < kNumSamples; ++i)
+            contiguous[i] = interleaved[i * 2];
+
+        MeasurementKernel::PcmFormat const format { encoding };
+
+        auto measure = [&] (const std::vector<IntType>& samples, size_t const stride) {
+            return MeasurementKernel::measurePcm (
+                samples.data(), stride, kNumSamples, format, 1.f, [] (uint64_t, const float*, int, int) {});
+        };
+
+        logNanosecondsPerSample (juce::String (name) + " contiguous", [&] {
+            return measure (contiguous, sizeof (IntType));
+        });
+        logNanosecondsPerSample (juce::String (name) + " interleaved", [&] {
+            return measure (interleaved, sizeof (IntType) * 2);
+        });
+    }
+
+    /**
+     * Measures interleaved frames channel by channel, which strides over all frames for every channel, and frame-wise,
+     * which decodes all channels of a chunk of frames in one pass.
+     */
+    template <typename SampleType>
+    void runInterleavedBenchmark (
+        const char* name,
+        MeasurementKernel::PcmEncoding const encoding,
+        int const numChannels,
+        double const maxCode)
+    {
+        auto const numFrames = kNumInterleavedSamples / numChannels;
+        std::vector<SampleType> frames (static_cast<size_t> (numFrames * numChannels));
+        for (size_t i = 0; i < frames.size(); ++i)
+            frames[i] = static_cast<SampleType> (getTestSignal (i) * maxCode);
+
+        MeasurementKernel::PcmFormat const format { encoding };
+        auto const frameStride = sizeof (SampleType) * static_cast<size_t> (numChannels);
+        std::vector<MeasurementKernel::Result> results (static_cast<size_t> (numChannels));
+        auto const prefix = juce::String (name) + " " + juce::String (numChannels) + " channels ";
+
+        logNanosecondsPerSample (prefix + "per channel", [&] {
+            MeasurementKernel::Result peak;
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto const result = MeasurementKernel::measurePcm (
+                    frames.data() + ch, frameStride, numFrames, format, 1.f, [] (uint64_t, const float*, int, int) {});
+                peak.peak = std::max (peak.peak, result.peak);
+            }
+            return peak;
+        }, kNumInterleavedSamples, kNumInterleavedRepetitions);
+
+        logNanosecondsPerSample (prefix + "frame-wise", [&] {
+            MeasurementKernel::measureInterleaved (
+                frames.data(),
+                frameStride,
+                numChannels,
+                numFrames,
+                format,
+                1.f,
+                results.data(),
+                [] (int, uint64_t, const float*, int, int) {});
+
+            MeasurementKernel::Result peak;
+            for (auto const& result : results)
+                peak.peak = std::max (peak.peak, result.peak);
+            return peak;
+        }, kNumInterleavedSamples, kNumInterleavedRepetitions);
+    }
+
+    template <typename Function>
+    void logNanosecondsPerSample (
+        const juce::String& name,
+        Function function,
+        int const numSamples = kNumSamples,
+        int const numRepetitions = kNumRepetitions)
+    {
+        double peak = 0.0;
+
+        auto const startTicks = juce::Time::getHighResolutionTicks();
+
+        for (int r = 0; r < numRepetitions; ++r)
+            peak += function().peak;
+
+        auto const elapsedTicks = juce::Time::getHighResolutionTicks() - startTicks;
+        auto const seconds = juce::Time::highResolutionTicksToSeconds (elapsedTicks);
+        auto const nanoseconds = seconds * 1e9 / (static_cast<double> (numSamples) * numRepetitions);
+
+        // Logging the peak keeps the compiler from dropping repetitions.
+        logMessage (name + ": " + juce::String (nanoseconds, 3) + " ns per sample (peak "
+                    + juce::String (peak / numRepetitions, 2) + ")");
+    }
+};
+
+static MeasurementKernelBenchmarks measurementKernelBenchmarks;
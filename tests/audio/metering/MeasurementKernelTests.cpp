@@ -0,0 +1,184 @@
+#include "juce-extensions/audio/metering/MeasurementKernel.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class MeasurementKernelTests : public juce::UnitTest
+{
+public:
+    MeasurementKernelTests() : juce::UnitTest ("MeasurementKernel", "Metering") {}
+
+    void runTest() override
+    {
+        beginTest ("Contiguous and interleaved PCM samples give the same results");
+        {
+            expectSameResults<int16_t> (MeasurementKernel::PcmEncoding::int16, 32768.0);
+            expectSameResults<int32_t> (MeasurementKernel::PcmEncoding::int24in32, 8388608.0);
+            expectSameResults<int32_t> (MeasurementKernel::PcmEncoding::int32, 2147483648.0);
+        }
+
+        beginTest ("Interleaved frames give the same results as planar channels");
+        {
+            using Encoding = MeasurementKernel::PcmEncoding;
+
+            for (auto const encoding : { Encoding::int8,
+                                         Encoding::uint8,
+                                         Encoding::int16,
+                                         Encoding::int24,
+                                         Encoding::int24in32,
+                                         Encoding::int32,
+                                         Encoding::float32 })
+            {
+                for (auto const isBigEndian : { false, true })
+                {
+                    // Mono, stereo, odd numbers of channels, multiples of 4, and more than a single pass holds.
+                    for (auto const numChannels : { 1, 2, 3, 4, 8, 11, 16 })
+                        expectSameInterleavedResults ({ encoding, isBigEndian }, numChannels);
+                }
+            }
+        }
+    }
+
+private:
+    /// Not a multiple of the chunk size or of the SSE width, so that the remainders are decoded sample by sample too.
+    static constexpr int kNumSamples = 203;
+
+    /**
+     * Measures samples once contiguously and once interleaved with a second channel. Contiguous samples take the SSE2
+     * decoding where available, interleaved samples are always decoded sample by sample.
+     */
+    template <typename IntType>
+    void expectSameResults (MeasurementKernel::PcmEncoding const encoding, double const fullScale)
+    {
+        std::vector<IntType> contiguous (kNumSamples);
+        std::vector<IntType> interleaved (kNumSamples * 2, IntType (0));
+
+        for (int i = 0; i < kNumSamples; ++i)
+        {
+            // A sweep over the full range of the encoding, including both ends.
+            auto const level = -1.0 + 2.0 * i / (kNumSamples - 1);
+            auto const value = static_cast<IntType> (juce::jlimit (-fullScale, fullScale - 1.0, level * fullScale));
+            contiguous[static_cast<size_t> (i)] = value;
+            interleaved[static_cast<size_t> (i) * 2] = value;
+        }
+
+        MeasurementKernel::PcmFormat const format { encoding };
+        auto const threshold = format.getMaxLevel();
+
+        std::vector<float> contiguousDecoded;
+        std::vector<uint64_t> contiguousMasks;
+        auto const contiguousResult = MeasurementKernel::measurePcm (
+            contiguous.data(),
+            sizeof (IntType),
+            kNumSamples,
+            format,
+            threshold,
+            [&] (uint64_t const mask, const float* chunk, int, int const length) {
+                contiguousDecoded.insert (contiguousDecoded.end(), chunk, chunk + length);
+                contiguousMasks.push_back (mask);
+            });
+
+        std::vector<float> interleavedDecoded;
+        std::vector<uint64_t> interleavedMasks;
+        auto const interleavedResult = MeasurementKernel::measurePcm (
+            interleaved.data(),
+            sizeof (IntType) * 2,
+            kNumSamples,
+            format,
+            threshold,
+            [&] (uint64_t const mask, const float* chunk, int, int const length) {
+                interleavedDecoded.insert (interleavedDecoded.end(), chunk, chunk + length);
+                interleavedMasks.push_back (mask);
+            });
+
+        expect (contiguousDecoded == interleavedDecoded);
+        expect (contiguousMasks == interleavedMasks);
+        expectEquals (contiguousResult.peak, interleavedResult.peak);
+        expectEquals (contiguousResult.sum, interleavedResult.sum);
+        expectEquals (contiguousResult.sumSquares, interleavedResult.sumSquares);
+        expectEquals (contiguousResult.peak, 1.0);
+    }
+
+    /**
+     * Measures the same samples once as interleaved frames and once channel by channel.
+     */
+    void expectSameInterleavedResults (MeasurementKernel::PcmFormat const format, int const numChannels)
+    {
+        auto const bytesPerSample = static_cast<size_t> (format.getBytesPerSample());
+        auto const frameStride = bytesPerSample * static_cast<size_t> (numChannels);
+
+        // Random bytes cover every code, including NaN, infinite and denormal floats.
+        std::vector<uint8_t> frames (frameStride * kNumSamples);
+        uint32_t seed = 12345;
+        for (auto& byte : frames)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            byte = static_cast<uint8_t> (seed >> 24);
+        }
+
+        std::vector<std::vector<uint8_t>> channels (static_cast<size_t> (numChannels));
+        for (size_t ch = 0; ch < channels.size(); ++ch)
+        {
+            for (size_t i = 0; i < kNumSamples; ++i)
+            {
+                auto const* sample = frames.data() + i * frameStride + ch * bytesPerSample;
+                channels[ch].insert (channels[ch].end(), sample, sample + bytesPerSample);
+            }
+        }
+
+        auto const threshold = 0.5f;
+
+        std::vector<std::vector<float>> interleavedDecoded (channels.size());
+        std::vector<std::vector<uint64_t>> interleavedMasks (channels.size());
+        std::vector<MeasurementKernel::Result> interleavedResults (channels.size());
+        MeasurementKernel::measureInterleaved (
+            frames.data(),
+            frameStride,
+            numChannels,
+            kNumSamples,
+            format,
+            threshold,
+            interleavedResults.data(),
+            [&] (int const ch, uint64_t const mask, const float* chunk, int, int const length) {
+                auto const index = static_cast<size_t> (ch);
+                interleavedDecoded[index].insert (interleavedDecoded[index].end(), chunk, chunk + length);
+                interleavedMasks[index].push_back (mask);
+            });
+
+        for (size_t ch = 0; ch < channels.size(); ++ch)
+        {
+            std::vector<float> planarDecoded;
+            std::vector<uint64_t> planarMasks;
+            auto const planarResult = MeasurementKernel::measurePcm (
+                channels[ch].data(),
+                bytesPerSample,
+                kNumSamples,
+                format,
+                threshold,
+                [&] (uint64_t const mask, const float* chunk, int, int const length) {
+                    planarDecoded.insert (planarDecoded.end(), chunk, chunk + length);
+                    planarMasks.push_back (mask);
+                });
+
+            auto const& interleavedResult = interleavedResults[ch];
+
+            // NaNs don't compare equal, so compare the bits.
+            expect (planarDecoded.size() == interleavedDecoded[ch].size()
+                    && std::memcmp (
+                           planarDecoded.data(),
+                           interleavedDecoded[ch].data(),
+                           planarDecoded.size() * sizeof (float))
+                           == 0);
+            expect (planarMasks == interleavedMasks[ch]);
+            expectEquals (interleavedResult.peak, planarResult.peak);
+            expectEquals (interleavedResult.sum, planarResult.sum);
+            expectEquals (interleavedResult.sumSquares, planarResult.sumSquares);
+            expectEquals (interleavedResult.numNaNs, planarResult.numNaNs);
+            expectEquals (interleavedResult.numInfs, planarResult.numInfs);
+            expectEquals (interleavedResult.numDenormals, planarResult.numDenormals);
+        }
+    }
+};
+
+static MeasurementKernelTests measurementKernelTests;
@@ -0,0 +1,111 @@
+#include "juce-extensions/components/metering/MeterBridgeComponent.h"
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+/**
+ * Measures the time per frame of a MeterBridgeComponent which shows many channels: refreshing the level meters, which
+ * forwards all measurements into the bridge, and painting the bridge. Run with --benchmarks.
+ */
+class MeterBridgeComponentBenchmarks : public juce::UnitTest
+{
+public:
+    MeterBridgeComponentBenchmarks() : juce::UnitTest ("MeterBridgeComponent", "Benchmarks") {}
+
+    void runTest() override
+    {
+        for (auto const numChannels : { 64, 256, 1024 })
+        {
+            beginTest (juce::String (numChannels) + " channels");
+            runBenchmark (numChannels);
+        }
+    }
+
+private:
+    static constexpr int kChannelsPerMeter = 8;
+    static constexpr int kBlockSize = 512;
+    static constexpr int kNumFrames = 200;
+    static constexpr double kSampleRate = 48000.0;
+
+    static constexpr int kWidth = 1600;
+    static constexpr int kHeight = 900;
+
+    void runBenchmark (int const numChannels)
+    {
+        // The bars of 1024 channels are narrower than a pixel, so leave no space between them.
+        auto options = MeterBridgeComponent::Options::getDefault();
+        options.barSeparationSpace = 0.f;
+
+        MeterBridgeComponent bridge (LevelMeter::Scale::getDefaultScale(), options);
+        bridge.setSize (kWidth, kHeight);
+
+        std::vector<std::unique_ptr<LevelMeter>> levelMeters;
+        for (int i = 0; i < numChannels / kChannelsPerMeter; ++i)
+        {
+            levelMeters.push_back (std::make_unique<LevelMeter>());
+            levelMeters.back()->prepareToPlay (kChannelsPerMeter, kSampleRate);
+            bridge.addLevelMeter (*levelMeters.back());
+        }
+
+        std::vector<std::vector<float>> block (kChannelsPerMeter, std::vector<float> (kBlockSize));
+        std::vector<const float*> channels;
+        for (auto const& channel : block)
+            channels.push_back (channel.data());
+
+        juce::Image image (juce::Image::ARGB, kWidth, kHeight, true);
+        juce::Graphics g (image);
+
+        juce::int64 refreshTicks = 0;
+        juce::int64 paintTicks = 0;
+
+        for (int frame = 0; frame < kNumFrames; ++frame)
+        {
+            for (size_t meter = 0; meter < levelMeters.size(); ++meter)
+            {
+                fillBlock (block, frame, static_cast<int> (meter));
+                levelMeters[meter]->measureBlock (channels.data(), kChannelsPerMeter, kBlockSize);
+            }
+
+            auto const refreshStartTicks = juce::Time::getHighResolutionTicks();
+
+            for (auto& levelMeter : levelMeters)
+                levelMeter->poll();
+
+            auto const paintStartTicks = juce::Time::getHighResolutionTicks();
+
+            bridge.paint (g);
+
+            auto const endTicks = juce::Time::getHighResolutionTicks();
+            refreshTicks += paintStartTicks - refreshStartTicks;
+            paintTicks += endTicks - paintStartTicks;
+        }
+
+        expectEquals (bridge.getNumChannels(), numChannels);
+
+        logMessage (juce::String (numChannels) + " channels: refresh " + getMicrosecondsPerFrame (refreshTicks)
+                    + " us, paint " + getMicrosecondsPerFrame (paintTicks) + " us per frame");
+    }
+
+    /**
+     * Fills a block with a sine per channel, with a level which changes per frame, so that every bar moves.
+     */
+    static void fillBlock (std::vector<std::vector<float>>& block, int const frame, int const meterIndex)
+    {
+        for (size_t ch = 0; ch < block.size(); ++ch)
+        {
+            auto const channelIndex = meterIndex * kChannelsPerMeter + static_cast<int> (ch);
+            auto const level = 0.5 + 0.5 * std::sin (0.1 * frame + channelIndex);
+
+            for (size_t i = 0; i < block[ch].size(); ++i)
+                block[ch][i] = static_cast<float> (level * std::sin (0.05 * static_cast<double> (i)));
+        }
+    }
+
+    static juce::String getMicrosecondsPerFrame (juce::int64 const ticks)
+    {
+        return juce::String (juce::Time::highResolutionTicksToSeconds (ticks) * 1e6 / kNumFrames, 1);
+    }
+};
+
+static MeterBridgeComponentBenchmarks meterBridgeComponentBenchmarks;